@@ -0,0 +1,147 @@
+#include "Alloc.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<std::uint64_t>  g_count         { 0 };
+    std::atomic<std::uint64_t>  g_bytes         { 0 };
+    std::atomic<std::uint64_t>  g_violations    { 0 };
+    std::atomic<bool>           g_strict        { false };
+
+    // Plain types only: these are used from operator new, so they can't allocate to get set up
+    thread_local std::uint64_t  t_count         = 0;
+    thread_local std::uint64_t  t_bytes         = 0;
+    thread_local const char *   t_noAlloc       = nullptr;  // innermost NoAlloc scope's name
+
+#ifndef GEOWARS_LIBRARY
+    void * allocate(std::size_t size)
+    {
+        g_count.fetch_add(1, std::memory_order_relaxed);
+        g_bytes.fetch_add(size, std::memory_order_relaxed);
+        t_count++;
+        t_bytes += size;
+
+        if (t_noAlloc != nullptr)
+        {
+            g_violations.fetch_add(1, std::memory_order_relaxed);
+
+            if (g_strict.load(std::memory_order_relaxed))
+            {
+                // stdio and not std::cout, which could allocate (and come back here)
+                std::fprintf(stderr, "Error allocation of %zu bytes inside no-allocation region '%s'.\n", size, t_noAlloc);
+                std::abort();
+            }
+        }
+
+        void * p = std::malloc(size != 0 ? size : 1);
+        if (p == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+#endif
+}
+
+std::uint64_t alloc::count()
+{
+    return g_count.load(std::memory_order_relaxed);
+}
+
+std::uint64_t alloc::bytes()
+{
+    return g_bytes.load(std::memory_order_relaxed);
+}
+
+std::uint64_t alloc::threadCount()
+{
+    return t_count;
+}
+
+std::uint64_t alloc::threadBytes()
+{
+    return t_bytes;
+}
+
+std::uint64_t alloc::violations()
+{
+    return g_violations.load(std::memory_order_relaxed);
+}
+
+/**
+ * Turns strict mode on or off: when on, allocating inside a NoAlloc scope aborts the game.
+ */
+void alloc::setStrict(bool strict)
+{
+    g_strict = strict;
+}
+
+bool alloc::strict()
+{
+    return g_strict;
+}
+
+/**
+ * Starts a no-allocation region on this thread.
+ * 
+ * name - what the region is (printed if it allocates in strict mode), must outlive the scope
+ */
+alloc::NoAlloc::NoAlloc(const char * name)
+    : m_previous(t_noAlloc)
+{
+    t_noAlloc = name;
+}
+
+alloc::NoAlloc::~NoAlloc()
+{
+    t_noAlloc = m_previous;
+}
+
+alloc::AllowAlloc::AllowAlloc()
+    : m_previous(t_noAlloc)
+{
+    t_noAlloc = nullptr;
+}
+
+alloc::AllowAlloc::~AllowAlloc()
+{
+    t_noAlloc = m_previous;
+}
+
+// Replacing these replaces every form of new & delete (the array and nothrow ones call these). Not in libgeowars.so:
+// a library mustn't replace the new & delete of the program that loads it (so nothing is counted there).
+#ifndef GEOWARS_LIBRARY
+void * operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void * operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void * p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void * p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void * p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void * p, std::size_t) noexcept
+{
+    std::free(p);
+}
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Counts heap allocations (every operator new in the process), in total and per thread, and can catch
+ * allocations where there shouldn't be any.
+ * 
+ * Code that should never allocate once the game is warmed up is marked with an alloc::NoAlloc scope. An allocation
+ * inside one is counted as a violation, and in strict mode (a debug mode, see setStrict()) it aborts the game with
+ * the scope's name, so the allocation can be found with a debugger or a core dump.
+ */
+namespace alloc
+{
+    std::uint64_t count();          // allocations so far
+    std::uint64_t bytes();          // bytes allocated so far (not taking frees away)
+    std::uint64_t threadCount();    // allocations so far on this thread
+    std::uint64_t threadBytes();
+    std::uint64_t violations();     // allocations inside NoAlloc scopes so far
+
+    void setStrict(bool strict);
+    bool strict();
+
+    /**
+     * Marks a region (the scope's lifetime) where this thread must not allocate. They can be nested.
+     */
+    class NoAlloc
+    {
+    public:
+        explicit NoAlloc(const char * name);
+        ~NoAlloc();
+
+        NoAlloc(const NoAlloc &) = delete;
+        NoAlloc & operator = (const NoAlloc &) = delete;
+
+    private:
+        const char * m_previous;
+    };
+
+    /**
+     * Lifts any NoAlloc scope for the scope's lifetime, for allocations that are expected (e.g. filling a cache
+     * the first time it's used).
+     */
+    class AllowAlloc
+    {
+    public:
+        AllowAlloc();
+        ~AllowAlloc();
+
+        AllowAlloc(const AllowAlloc &) = delete;
+        AllowAlloc & operator = (const AllowAlloc &) = delete;
+
+    private:
+        const char * m_previous;
+    };
+
+    /**
+     * Counts this thread's allocations between laps (like Stopwatch, for systems that run one after another).
+     */
+    class Counter
+    {
+    public:
+        struct Lap { std::uint64_t count; std::uint64_t bytes; };
+
+        /**
+         * Returns the allocations since the last lap (or since the counter was created), and starts a new lap.
+         */
+        Lap lap()
+        {
+            const Lap now = { threadCount(), threadBytes() };
+            const Lap lap = { now.count - m_start.count, now.bytes - m_start.bytes };
+            m_start = now;
+            return lap;
+        }
+
+    private:
+        Lap m_start = { threadCount(), threadBytes() };
+    };
+}
@@ -0,0 +1,18 @@
+#include "Assets.h"
+
+// Symbols made by 'ld -r -b binary sofachromergit.otf'
+extern "C"
+{
+    extern const unsigned char _binary_sofachromergit_otf_start[];
+    extern const unsigned char _binary_sofachromergit_otf_end[];
+}
+
+const unsigned char * assets::fontData()
+{
+    return _binary_sofachromergit_otf_start;
+}
+
+std::size_t assets::fontSize()
+{
+    return _binary_sofachromergit_otf_end - _binary_sofachromergit_otf_start;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Assets embedded into the executable at build time (see the Makefile), so the game doesn't depend on files
+ * being where it expects them.
+ */
+namespace assets
+{
+    const unsigned char * fontData();
+    std::size_t           fontSize();
+}
@@ -0,0 +1,283 @@
+#include "Audio.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    // How each effect sounds, and how it shares the voices. Effects are made from a tone sweeping from one
+    // frequency to another (sine, or square), mixed with noise, fading out over the effect's length.
+    struct Effect
+    {
+        int     priority;   // effects take voices from less important ones
+        int     voices;     // most voices it plays on at once (its oldest one is taken over past that)
+        int     gapMs;      // it doesn't start again sooner than this after it last did
+        float   seconds;
+        float   from;       // Hz
+        float   to;
+        float   noise;      // 0 (tone only) to 1 (noise only)
+        bool    square;
+        float   volume;
+    };
+
+    const Effect EFFECTS[SoundEffect::TYPE_COUNT] =
+    {
+        //  priority    voices  gapMs   seconds from    to      noise   square  volume
+        {   0,          4,      45,     0.09f,  1400,   500,    0.1f,   true,   0.25f },    // SHOT
+        {   1,          4,      30,     0.15f,  500,    200,    0.5f,   false,  0.5f  },    // SPLIT
+        {   2,          6,      35,     0.4f,   160,    50,     0.8f,   false,  0.8f  },    // KILL
+        {   4,          1,      0,      1.2f,   300,    40,     0.6f,   true,   1     },    // DEATH
+        {   3,          2,      0,      1.6f,   90,     25,     0.7f,   false,  1     },    // NUKE
+    };
+
+    const float ATTACK = 0.003f;    // seconds effects take to fade in (so they don't click)
+    const float PI = 3.14159265f;
+
+    /**
+     * Makes an effect's samples (mono, 16 bit).
+     */
+    std::vector<std::int16_t> synthesise(const Effect & effect, int rate, Random & random)
+    {
+        std::vector<std::int16_t> samples((size_t) (effect.seconds * rate));
+        float phase = 0;
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            const float t = (float) i / rate;
+            const float along = t / effect.seconds;
+
+            // Exponential sweep (sounds even), exponential fade (down to under 1% by the end)
+            const float frequency = effect.from * std::pow(effect.to / effect.from, along);
+            phase += 2 * PI * frequency / rate;
+            const float tone = effect.square ? (std::sin(phase) >= 0 ? 1.0f : -1.0f) : std::sin(phase);
+            const float noise = (float) random.fromRange(-32767, 32767) / 32767;
+            const float envelope = std::min(1.0f, t / ATTACK) * std::exp(-5 * along);
+
+            samples[i] = (std::int16_t) (32767 * 0.9f * envelope * (tone * (1 - effect.noise) + noise * effect.noise));
+        }
+        return samples;
+    }
+}
+
+/**
+ * Makes every effect's samples, and the voices.
+ *
+ * config  - number of voices, sample rate, and volume
+ * offline - true to mix into buffers (mix()) instead of playing on the audio device
+ */
+AudioSystem::AudioSystem(const AudioConfig & config, bool offline)
+    : m_config(config), m_offline(offline), m_voices(std::max(0, config.VOICES))
+{
+    std::fill(m_lastStart, m_lastStart + SoundEffect::TYPE_COUNT, -1);
+
+    // Always the same sounds
+    Random random(1);
+    for (const Effect & effect : EFFECTS)
+    {
+        m_samples.push_back(synthesise(effect, m_config.RATE, random));
+    }
+
+    if (m_offline)
+    {
+        return;
+    }
+
+    m_buffers.resize(SoundEffect::TYPE_COUNT);
+    for (int type = 0; type < SoundEffect::TYPE_COUNT; type++)
+    {
+        if (!m_buffers[type].loadFromSamples(m_samples[type].data(), m_samples[type].size(), 1, m_config.RATE))
+        {
+            std::cout << "Error with loading sound effects.\n";
+        }
+    }
+    m_sounds.resize(m_voices.size());
+}
+
+/**
+ * Starts an effect on a voice (a free one, or one taken over), or drops it if there's none it can have.
+ */
+void AudioSystem::play(const SoundEffect & effect)
+{
+    const Effect & info = EFFECTS[effect.type];
+
+    // The same effect again straight away wouldn't be heard anyway
+    if (m_lastStart[effect.type] >= 0 && m_time - m_lastStart[effect.type] < (std::int64_t) info.gapMs * m_config.RATE / 1000)
+    {
+        m_dropped++;
+        return;
+    }
+
+    // A free voice, this effect's oldest voice, and the voice of the least important (then oldest) effect playing
+    int free = -1;
+    int same = 0;
+    int oldestSame = -1;
+    int leastImportant = -1;
+    for (int v = 0; v < (int) m_voices.size(); v++)
+    {
+        const Voice & voice = m_voices[v];
+        if (!isBusy(voice))
+        {
+            free = free < 0 ? v : free;
+            continue;
+        }
+
+        if (voice.type == effect.type)
+        {
+            same++;
+            if (oldestSame < 0 || voice.start < m_voices[oldestSame].start)
+            {
+                oldestSame = v;
+            }
+        }
+
+        if (leastImportant < 0 || voice.priority < m_voices[leastImportant].priority
+            || (voice.priority == m_voices[leastImportant].priority && voice.start < m_voices[leastImportant].start))
+        {
+            leastImportant = v;
+        }
+    }
+
+    if (same >= info.voices)
+    {
+        m_stolen++;
+        start(oldestSame, effect);
+    }
+    else if (free >= 0)
+    {
+        start(free, effect);
+    }
+    else if (leastImportant >= 0 && m_voices[leastImportant].priority <= info.priority)
+    {
+        m_stolen++;
+        start(leastImportant, effect);
+    }
+    else
+    {
+        m_dropped++;
+    }
+}
+
+/**
+ * Moves the clock on (voices are free again once their effect is over). Offline, mix() does that instead.
+ *
+ * dt - seconds since the last update
+ */
+void AudioSystem::update(float dt)
+{
+    if (!m_offline)
+    {
+        m_time += (std::int64_t) std::lround(dt * m_config.RATE);
+    }
+}
+
+/**
+ * Offline: mixes the next frames of every voice playing (mono, at AudioConfig's RATE), and moves the clock on by as
+ * much. Effects started since the last mix start at the beginning of the buffer.
+ *
+ * out    - where to write the mix
+ * frames - how many frames to mix
+ */
+void AudioSystem::mix(std::int16_t * out, size_t frames)
+{
+    if (m_mixBuffer.size() < frames)
+    {
+        m_mixBuffer.resize(frames);
+    }
+    std::fill(m_mixBuffer.begin(), m_mixBuffer.begin() + frames, 0.0f);
+
+    for (const Voice & voice : m_voices)
+    {
+        if (!isBusy(voice))
+        {
+            continue;
+        }
+
+        const std::vector<std::int16_t> & samples = m_samples[voice.type];
+        const size_t position = (size_t) (m_time - voice.start);
+        const size_t count = std::min(frames, samples.size() - position);
+        const std::int16_t * from = samples.data() + position;
+        const float gain = voice.gain;
+        float * sums = m_mixBuffer.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            sums[i] += from[i] * gain;
+        }
+    }
+
+    // (clipped, not compressed: the gains leave headroom for a few loud effects at once)
+    for (size_t i = 0; i < frames; i++)
+    {
+        out[i] = (std::int16_t) std::max(-32768.0f, std::min(32767.0f, m_mixBuffer[i]));
+    }
+
+    m_time += frames;
+}
+
+int AudioSystem::voices() const
+{
+    return (int) m_voices.size();
+}
+
+int AudioSystem::busyVoices() const
+{
+    int busy = 0;
+    for (const Voice & voice : m_voices)
+    {
+        busy += isBusy(voice) ? 1 : 0;
+    }
+    return busy;
+}
+
+// most voices busy at once so far
+int AudioSystem::mostBusyVoices() const
+{
+    return m_mostBusy;
+}
+
+long AudioSystem::played() const
+{
+    return m_played;
+}
+
+long AudioSystem::stolen() const
+{
+    return m_stolen;
+}
+
+long AudioSystem::dropped() const
+{
+    return m_dropped;
+}
+
+bool AudioSystem::isBusy(const Voice & voice) const
+{
+    return voice.type >= 0 && m_time < voice.start + (std::int64_t) m_samples[voice.type].size();
+}
+
+/**
+ * Starts an effect on a voice (cutting short whatever it was playing).
+ */
+void AudioSystem::start(int voice, const SoundEffect & effect)
+{
+    const Effect & info = EFFECTS[effect.type];
+
+    Voice & v = m_voices[voice];
+    v.type = effect.type;
+    v.priority = info.priority;
+    v.start = m_time;
+    v.gain = effect.volume * info.volume * m_config.VOL / 100;
+
+    m_lastStart[effect.type] = m_time;
+    m_played++;
+    m_mostBusy = std::max(m_mostBusy, busyVoices());
+
+    if (!m_offline)
+    {
+        sf::Sound & sound = m_sounds[voice];
+        sound.stop();
+        sound.setBuffer(m_buffers[effect.type]);
+        sound.setVolume(std::min(100.0f, v.gain * 100));
+        sound.play();
+    }
+}
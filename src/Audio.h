@@ -0,0 +1,67 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SoundEffect.h"
+
+// Sound. VOICES: effects that can play at once (the voice pool), RATE: samples per second the effects are made at (and
+// offline mixing mixes at), VOL: volume (0 to 100).
+struct AudioConfig { int VOICES = 24, RATE = 44100; float VOL = 60; };
+
+/**
+ * Plays sound effects on a fixed pool of voices, so however many the game asks for at once (a nuke blows up hundreds
+ * of enemies on the same tick), only so many ever play.
+ *
+ * Every effect is made once, up front, into one sample buffer that all the voices playing it share. Effects have a
+ * priority, a most voices they may take, and a gap they don't start again within. When every voice is busy, an effect
+ * takes the voice of the least important effect playing (the oldest one, if there are a few), unless all of them are
+ * more important than it is, in which case it's dropped.
+ *
+ * Offline (no audio device), nothing is played: mix() mixes the voices into a buffer instead, so what mixing costs and
+ * how many voices are used can be measured headless.
+ */
+class AudioSystem
+{
+public:
+    AudioSystem(const AudioConfig & config, bool offline);
+
+    void play(const SoundEffect & effect);
+    void update(float dt);
+    void mix(std::int16_t * out, size_t frames);
+
+    int voices() const;
+    int busyVoices() const;
+    int mostBusyVoices() const;
+    long played() const;
+    long stolen() const;
+    long dropped() const;
+
+private:
+    // A voice of the pool (start is in frames, on the pool's clock)
+    struct Voice
+    {
+        int             type    = -1;   // SoundEffect::Type playing, -1 if it's free
+        int             priority = 0;
+        std::int64_t    start   = 0;
+        float           gain    = 0;
+    };
+
+    AudioConfig                             m_config;
+    bool                                    m_offline;
+    std::vector<std::vector<std::int16_t>>  m_samples;      // per effect type (mono)
+    std::vector<sf::SoundBuffer>            m_buffers;      // per effect type, shared by the voices (not offline)
+    std::vector<Voice>                      m_voices;
+    std::vector<sf::Sound>                  m_sounds;       // per voice (not offline)
+    std::vector<float>                      m_mixBuffer;    // offline mixing's sums, kept around so it's not reallocated
+    std::int64_t                            m_time          = 0;    // frames played so far
+    std::int64_t                            m_lastStart[SoundEffect::TYPE_COUNT];
+    int                                     m_mostBusy      = 0;
+    long                                    m_played        = 0;
+    long                                    m_stolen        = 0;    // effects cut short for more important ones
+    long                                    m_dropped       = 0;    // effects that didn't get a voice (or came too soon)
+
+    bool isBusy(const Voice & voice) const;
+    void start(int voice, const SoundEffect & effect);
+};
@@ -0,0 +1,316 @@
+#include "BatchRunner.h"
+#include "Stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    // A setting batch mode can override (BatchConfig's SET), "<section>.<name>"
+    struct Override
+    {
+        const char *        name;
+        int EnemyConfig::*  enemyInt;
+        float EnemyConfig::* enemyFloat;
+        int NukeConfig::*   nukeInt;
+        float NukeConfig::* nukeFloat;
+    };
+
+    const Override OVERRIDES[] =
+    {
+        { "enemy.SR",   &EnemyConfig::SR,   nullptr,            nullptr,            nullptr },
+        { "enemy.CR",   &EnemyConfig::CR,   nullptr,            nullptr,            nullptr },
+        { "enemy.VMIN", &EnemyConfig::VMIN, nullptr,            nullptr,            nullptr },
+        { "enemy.VMAX", &EnemyConfig::VMAX, nullptr,            nullptr,            nullptr },
+        { "enemy.L",    &EnemyConfig::L,    nullptr,            nullptr,            nullptr },
+        { "enemy.SI",   &EnemyConfig::SI,   nullptr,            nullptr,            nullptr },
+        { "enemy.SNE",  &EnemyConfig::SNE,  nullptr,            nullptr,            nullptr },
+        { "enemy.SSE",  &EnemyConfig::SSE,  nullptr,            nullptr,            nullptr },
+        { "enemy.SG",   &EnemyConfig::SG,   nullptr,            nullptr,            nullptr },
+        { "enemy.SMIN", nullptr,            &EnemyConfig::SMIN, nullptr,            nullptr },
+        { "enemy.SMAX", nullptr,            &EnemyConfig::SMAX, nullptr,            nullptr },
+        { "nuke.V",     nullptr,            nullptr,            &NukeConfig::V,     nullptr },
+        { "nuke.ER",    nullptr,            nullptr,            &NukeConfig::ER,    nullptr },
+        { "nuke.BR",    nullptr,            nullptr,            &NukeConfig::BR,    nullptr },
+        { "nuke.L",     nullptr,            nullptr,            &NukeConfig::L,     nullptr },
+        { "nuke.REL",   nullptr,            nullptr,            &NukeConfig::REL,   nullptr },
+        { "nuke.CDI",   nullptr,            nullptr,            &NukeConfig::CDI,   nullptr },
+        { "nuke.BVM",   nullptr,            nullptr,            nullptr,            &NukeConfig::BVM },
+    };
+
+    // An override as given: the setting, and its value in the first and the last game
+    struct Setting
+    {
+        const Override *    override;
+        float               first;
+        float               last;
+    };
+
+    /**
+     * Parses "<section>.<name>=<value>" or "<section>.<name>=<first>:<last>". Returns false if it's not an override.
+     */
+    bool parseSetting(const std::string & text, Setting & setting)
+    {
+        const size_t equals = text.find('=');
+        if (equals == std::string::npos)
+        {
+            return false;
+        }
+
+        const std::string name = text.substr(0, equals);
+        setting.override = nullptr;
+        for (const Override & override : OVERRIDES)
+        {
+            if (name == override.name)
+            {
+                setting.override = &override;
+            }
+        }
+        if (setting.override == nullptr)
+        {
+            return false;
+        }
+
+        const char * value = text.c_str() + equals + 1;
+        char * end = nullptr;
+        setting.first = std::strtof(value, &end);
+        setting.last = setting.first;
+        if (end == value)
+        {
+            return false;
+        }
+        if (*end == ':')
+        {
+            value = end + 1;
+            setting.last = std::strtof(value, &end);
+            if (end == value)
+            {
+                return false;
+            }
+        }
+        return *end == '\0';
+    }
+
+    /**
+     * Sets an override's value (int settings are rounded).
+     */
+    void apply(const Override & override, float value, EnemyConfig & enemyConfig, NukeConfig & nukeConfig)
+    {
+        const int rounded = (int) std::lround(value);
+        if (override.enemyInt != nullptr)   { enemyConfig.*override.enemyInt = rounded; }
+        if (override.enemyFloat != nullptr) { enemyConfig.*override.enemyFloat = value; }
+        if (override.nukeInt != nullptr)    { nukeConfig.*override.nukeInt = rounded; }
+        if (override.nukeFloat != nullptr)  { nukeConfig.*override.nukeFloat = value; }
+    }
+}
+
+/**
+ * threads - threads to step the simulations on, this one included (0 means one per CPU core)
+ */
+BatchRunner::BatchRunner(int threads)
+    : m_threads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency()))
+{
+    // This thread is one of them
+    for (int i = 1; i < m_threads; i++)
+    {
+        m_workers.emplace_back(&BatchRunner::work, this);
+    }
+}
+
+BatchRunner::~BatchRunner()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_start.notify_all();
+
+    for (std::thread & worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+/**
+ * Adds a simulation. Returns its index.
+ */
+size_t BatchRunner::add(const SimConfig & simConfig, const WorldConfig & worldConfig, const EnemyConfig & enemyConfig, const NukeConfig & nukeConfig)
+{
+    m_sims.push_back(std::unique_ptr<GameSim>(new GameSim(simConfig, worldConfig, enemyConfig, nukeConfig)));
+    return m_sims.size() - 1;
+}
+
+/**
+ * Simulates one tick of every simulation, and returns once they're all done.
+ *
+ * inputs - what each simulation's player does this tick (one per simulation, in the order they were added)
+ */
+void BatchRunner::step(const PlayerInput * inputs)
+{
+    // Small enough chunks that the threads finish at about the same time, big enough that taking one is rare
+    m_inputs = inputs;
+    m_chunk = std::max((size_t) 1, m_sims.size() / (m_threads * 16));
+    m_next = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_step++;
+        m_busy = (int) m_workers.size();
+    }
+    m_start.notify_all();
+
+    simulateChunks();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_busy == 0; });
+}
+
+size_t BatchRunner::size() const
+{
+    return m_sims.size();
+}
+
+int BatchRunner::threads() const
+{
+    return m_threads;
+}
+
+GameSim & BatchRunner::sim(size_t index)
+{
+    return *m_sims[index];
+}
+
+/**
+ * Worker thread main loop: helps with every step, until the runner is destroyed.
+ */
+void BatchRunner::work()
+{
+    long step = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_start.wait(lock, [this, step]() { return m_quit || m_step != step; });
+        if (m_quit)
+        {
+            return;
+        }
+        step = m_step;
+
+        lock.unlock();
+        simulateChunks();
+        lock.lock();
+
+        if (--m_busy == 0)
+        {
+            m_done.notify_one();
+        }
+    }
+}
+
+/**
+ * Takes chunks of simulations and simulates a tick of each, until there are none left in this step.
+ */
+void BatchRunner::simulateChunks()
+{
+    const size_t count = m_sims.size();
+    for (size_t first = m_next.fetch_add(m_chunk); first < count; first = m_next.fetch_add(m_chunk))
+    {
+        const size_t last = std::min(count, first + m_chunk);
+        for (size_t i = first; i < last; i++)
+        {
+            PlayerInput inputs[MAX_PLAYERS];
+            inputs[0] = m_inputs[i];
+            m_sims[i]->simulate(inputs);
+        }
+    }
+}
+
+int runBatch(const BatchConfig & batchConfig, const WorldConfig & worldConfig)
+{
+    std::vector<Setting> settings;
+    bool sweep = false;
+    for (const std::string & text : batchConfig.SET)
+    {
+        Setting setting;
+        if (!parseSetting(text, setting))
+        {
+            std::cout << "Error with config override " << text << " (it's <section>.<name>=<value> or <section>.<name>=<first>:<last>).\n";
+            return 1;
+        }
+        settings.push_back(setting);
+        sweep = sweep || setting.first != setting.last;
+    }
+
+    const int instances = std::max(1, batchConfig.INSTANCES);
+    BatchRunner runner(batchConfig.THREADS);
+
+    // Each game gets its own seed, and its own value of every override that's spread over the games
+    std::vector<std::vector<float>> values(instances);
+    for (int i = 0; i < instances; i++)
+    {
+        SimConfig simConfig;
+        simConfig.SEED = batchConfig.SEED + i;
+        simConfig.THREADS = 1;  // the runner's threads are busy enough
+        EnemyConfig enemyConfig;
+        NukeConfig nukeConfig;
+
+        const float along = instances > 1 ? (float) i / (instances - 1) : 0;
+        for (const Setting & setting : settings)
+        {
+            values[i].push_back(setting.first + (setting.last - setting.first) * along);
+            apply(*setting.override, values[i].back(), enemyConfig, nukeConfig);
+        }
+
+        runner.add(simConfig, worldConfig, enemyConfig, nukeConfig);
+    }
+
+    // Lockstep: every game's input for a tick is worked out from where it is before the tick is stepped
+    std::vector<PlayerInput> inputs(instances);
+    const int nukeTick = batchConfig.TICKS * 2 / 3;
+    Stopwatch stopwatch;
+    for (int tick = 0; tick < batchConfig.TICKS; tick++)
+    {
+        for (int i = 0; i < instances; i++)
+        {
+            inputs[i] = runner.sim(i).botInput(tick, nukeTick);
+        }
+        runner.step(inputs.data());
+    }
+    const double seconds = stopwatch.lap() / 1000;
+
+    // How the games went (a game's frame stops counting once it's over, so it's how long the player survived)
+    int over = 0;
+    double totalScore = 0;
+    int bestScore = 0;
+    std::uint64_t checksum = 14695981039346656037ull;
+    for (int i = 0; i < instances; i++)
+    {
+        GameSim & sim = runner.sim(i);
+        const int score = sim.score();
+        over += sim.isOver() ? 1 : 0;
+        totalScore += score;
+        bestScore = std::max(bestScore, score);
+        checksum = (checksum ^ sim.checksum()) * 1099511628211ull;
+
+        if (sweep)
+        {
+            std::cout << "game " << i << ":";
+            for (size_t s = 0; s < settings.size(); s++)
+            {
+                std::cout << " " << settings[s].override->name << "=" << values[i][s];
+            }
+            std::cout << ", score " << score << ", " << (sim.isOver() ? "died at tick " : "alive at tick ") << sim.currentFrame() << "\n";
+        }
+    }
+
+    const double steps = (double) instances * batchConfig.TICKS;
+    std::cout << "batch: " << instances << " games x " << batchConfig.TICKS << " ticks, seeds " << batchConfig.SEED << " to " << batchConfig.SEED + instances - 1 << "\n";
+    std::cout << "threads: " << runner.threads() << "\n";
+    std::cout << "steps: " << (long) steps << " in " << seconds << " s, " << (long) (steps / seconds) << " steps/s (" << (long) (steps / seconds / runner.threads()) << " per thread)\n";
+    std::cout << "games over: " << over << ", mean score: " << totalScore / instances << ", best score: " << bestScore << "\n";
+    std::cout << "checksum: " << std::hex << checksum << std::dec << "\n";
+    return 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "GameSim.h"
+
+// Batch mode (balance tuning, bot training): INSTANCES games with the seeds SEED, SEED + 1, ..., each played for TICKS ticks by the
+// headless mode's scripted player, stepped in lockstep on THREADS threads (0 is one per core). SET: EnemyConfig/NukeConfig overrides,
+// like "enemy.SI=30" (every game) or "enemy.SI=30:90" (spread evenly over the games, from the first one's value to the last one's).
+struct BatchConfig { int INSTANCES = 256, TICKS = 3600, THREADS = 0; unsigned SEED = 1; std::vector<std::string> SET; };
+
+/**
+ * Runs many independent simulations (GameSim) side by side, in lockstep: each step() simulates one tick of every
+ * one of them, shared out between a pool of threads, and returns once they all have (so the inputs for the next
+ * tick can be worked out from where every game is, e.g. by a bot being trained).
+ *
+ * The simulations share nothing, so the threads never wait for each other during a step, only at its end. They take
+ * simulations a few at a time until there are none left (some games cost more than others, a game full of enemies
+ * more than one that's over).
+ */
+class BatchRunner
+{
+public:
+    BatchRunner(int threads = 0);
+    ~BatchRunner();
+
+    size_t add(const SimConfig & simConfig, const WorldConfig & worldConfig, const EnemyConfig & enemyConfig, const NukeConfig & nukeConfig);
+    void step(const PlayerInput * inputs);
+
+    size_t size() const;
+    int threads() const;
+    GameSim & sim(size_t index);
+
+private:
+    std::vector<std::unique_ptr<GameSim>>   m_sims;
+    int                                     m_threads;
+    std::vector<std::thread>                m_workers;
+
+    // The step being run (written by step() while no worker is running)
+    const PlayerInput *                     m_inputs        = nullptr;  // per simulation, for its player 0
+    size_t                                  m_chunk         = 1;        // simulations taken at a time
+    std::atomic<size_t>                     m_next          { 0 };      // next simulation to take
+
+    std::mutex                              m_mutex;
+    std::condition_variable                 m_start;
+    std::condition_variable                 m_done;
+    long                                    m_step          = 0;        // steps started (workers start one when it goes up)
+    int                                     m_busy          = 0;        // workers still working on this step
+    bool                                    m_quit          = false;
+
+    void work();
+    void simulateChunks();
+};
+
+/**
+ * Runs batch mode: plays the games, and prints how fast they were stepped (steps per second, in total and per
+ * thread), how they went, and a checksum of how every game ended (the same with any number of threads).
+ *
+ * Returns the process exit code.
+ */
+int runBatch(const BatchConfig & batchConfig, const WorldConfig & worldConfig);
@@ -0,0 +1,228 @@
+#include "Bench.h"
+#include "Audio.h"
+#include "Vec2.h"
+#include "Particles.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const int   BODIES = 512;
+    const int   STEPS  = 200;
+    const float WIDTH  = 1280;
+    const float HEIGHT = 720;
+    const float RADIUS = 32;
+
+    const std::uint64_t FIXED_CHECKSUM = 0x2b1c8e7963a7474cULL;    // the fixed-point bodies after STEPS (the same on every machine)
+
+    const size_t PARTICLES          = 256 * 1024;
+    const int    PARTICLE_FRAMES    = 200;
+    const double PARTICLE_TARGET    = 50000;    // particles/ms (update + vertices): 256k particles in about a third of a 16.7 ms frame
+
+    const int    AUDIO_SECONDS      = 60;
+    const int    AUDIO_TICK_RATE    = 60;       // effects are asked for once a tick, like the game does
+    const double AUDIO_TARGET       = 100;      // times faster than real time (mixing a frame's worth in a small slice of it)
+
+    /**
+     * Moves bodies around a box for a number of steps, the same way enemies move in the game (bouncing off the walls
+     * and off each other). Returns how long it took in milliseconds.
+     */
+    template <typename T>
+    double simulate(std::vector<Vec2T<T>> & pos, std::vector<Vec2T<T>> & vel)
+    {
+        const T radius = RADIUS;
+        const T width = WIDTH;
+        const T height = HEIGHT;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int step = 0; step < STEPS; step++)
+        {
+            for (int i = 0; i < BODIES; i++)
+            {
+                if (pos[i].x - radius <= 0 || pos[i].x + radius >= width) { vel[i].x *= -1; }
+                if (pos[i].y - radius <= 0 || pos[i].y + radius >= height) { vel[i].y *= -1; }
+                pos[i] += vel[i];
+            }
+
+            for (int i = 0; i < BODIES; i++)
+            {
+                for (int j = i + 1; j < BODIES; j++)
+                {
+                    if (pos[i].distSqr(pos[j]) < (radius + radius) * (radius + radius))
+                    {
+                        Vec2T<T> dir = pos[i] - pos[j];
+                        dir.normalize();
+                        vel[i] = dir * vel[i].length();
+                        vel[j] = dir * (vel[j].length() * -1);
+                    }
+                }
+            }
+        }
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template <typename T>
+    void setup(std::vector<Vec2T<T>> & pos, std::vector<Vec2T<T>> & vel)
+    {
+        // Deterministic layout (no rand()) so every machine runs the same simulation
+        pos.resize(BODIES);
+        vel.resize(BODIES);
+        for (int i = 0; i < BODIES; i++)
+        {
+            pos[i] = Vec2T<T>(T(RADIUS + (i * 37) % int(WIDTH - 2 * RADIUS)), T(RADIUS + (i * 53) % int(HEIGHT - 2 * RADIUS)));
+            vel[i].polar(T(i * 7), T(3 + i % 4));
+        }
+    }
+}
+
+int runMathBenchmark()
+{
+    std::vector<Vec2T<float>> floatPos, floatVel;
+    std::vector<Vec2T<Fixed>> fixedPos, fixedVel;
+    setup(floatPos, floatVel);
+    setup(fixedPos, fixedVel);
+
+    const double floatMs = simulate(floatPos, floatVel);
+    const double fixedMs = simulate(fixedPos, fixedVel);
+
+    // FNV-1a over the raw fixed-point state
+    std::uint64_t checksum = 1469598103934665603ULL;
+    for (int i = 0; i < BODIES; i++)
+    {
+        const std::int64_t values[4] = { fixedPos[i].x.raw(), fixedPos[i].y.raw(), fixedVel[i].x.raw(), fixedVel[i].y.raw() };
+        unsigned char bytes[sizeof(values)];
+        std::memcpy(bytes, values, sizeof(values));
+        for (unsigned char b : bytes)
+        {
+            checksum = (checksum ^ b) * 1099511628211ULL;
+        }
+    }
+
+    std::cout << "bodies: " << BODIES << ", steps: " << STEPS << "\n";
+    std::cout << "float: " << floatMs << " ms\n";
+    std::cout << "fixed: " << fixedMs << " ms (" << fixedMs / floatMs << "x float)\n";
+    std::cout << "fixed checksum: " << std::hex << checksum << std::dec << "\n";
+
+    if (checksum != FIXED_CHECKSUM)
+    {
+        std::cout << "Error fixed-point checksum isn't the known good one (" << std::hex << FIXED_CHECKSUM << std::dec << "): fixed-point math isn't deterministic.\n";
+        return 1;
+    }
+    return 0;
+}
+
+int runParticleBenchmark()
+{
+    ParticleSystem particles(PARTICLES);
+    std::vector<sf::Vertex> vertices;
+    vertices.reserve(PARTICLES * 2);
+
+    // Fill it up with bursts that outlive the benchmark
+    Burst burst;
+    burst.speed = 400;
+    burst.life = 60;
+    burst.count = 1024;
+    burst.color = sf::Color::White;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < PARTICLES / burst.count; i++)
+    {
+        burst.x = (i * 37) % int(WIDTH);
+        burst.y = (i * 53) % int(HEIGHT);
+        particles.spawn(burst);
+    }
+    const double spawnMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    double updateMs = 0;
+    double vertexMs = 0;
+    for (int frame = 0; frame < PARTICLE_FRAMES; frame++)
+    {
+        start = std::chrono::steady_clock::now();
+        particles.update(1 / 60.0f);
+        auto updated = std::chrono::steady_clock::now();
+
+        vertices.clear();
+        particles.appendVertices(vertices);
+        auto done = std::chrono::steady_clock::now();
+
+        updateMs += std::chrono::duration<double, std::milli>(updated - start).count();
+        vertexMs += std::chrono::duration<double, std::milli>(done - updated).count();
+    }
+
+    const double total = (double) particles.liveCount() * PARTICLE_FRAMES;
+    const double perMs = total / (updateMs + vertexMs);
+
+    std::cout << "particles: " << particles.liveCount() << ", frames: " << PARTICLE_FRAMES << "\n";
+    std::cout << "spawn: " << PARTICLES / spawnMs << " particles/ms\n";
+    std::cout << "update: " << total / updateMs << " particles/ms\n";
+    std::cout << "vertices: " << total / vertexMs << " particles/ms\n";
+    std::cout << "update + vertices: " << perMs << " particles/ms (target " << PARTICLE_TARGET << ")\n";
+
+    if (perMs < PARTICLE_TARGET)
+    {
+        std::cout << "Error particle system is slower than its target.\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+int runAudioBenchmark()
+{
+    AudioConfig config;
+    AudioSystem audio(config, true);
+    std::vector<std::int16_t> mixed(config.RATE / AUDIO_TICK_RATE);
+
+    // The worst the game asks for: shooting all the time, enemies splitting and blowing up every tick, and a nuke
+    // blowing up two hundred of them at once every two seconds
+    std::uint64_t checksum = 14695981039346656037ull;
+    long busy = 0;
+    double mixMs = 0;
+    const int ticks = AUDIO_SECONDS * AUDIO_TICK_RATE;
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        audio.play(SoundEffect{ SoundEffect::SHOT });
+        audio.play(SoundEffect{ SoundEffect::SPLIT });
+        audio.play(SoundEffect{ SoundEffect::KILL });
+        if (tick % (2 * AUDIO_TICK_RATE) == 0)
+        {
+            audio.play(SoundEffect{ SoundEffect::NUKE });
+            for (int kill = 0; kill < 200; kill++)
+            {
+                audio.play(SoundEffect{ SoundEffect::KILL, 0.5f });
+            }
+        }
+        busy += audio.busyVoices();
+
+        auto start = std::chrono::steady_clock::now();
+        audio.mix(mixed.data(), mixed.size());
+        mixMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        for (std::int16_t sample : mixed)
+        {
+            checksum = (checksum ^ (std::uint16_t) sample) * 1099511628211ull;
+        }
+    }
+
+    const double realTime = AUDIO_SECONDS * 1000 / mixMs;
+
+    std::cout << "audio: " << AUDIO_SECONDS << " s mixed offline at " << config.RATE << " Hz, " << audio.voices() << " voices\n";
+    std::cout << "effects: " << audio.played() << " played (" << audio.stolen() << " took a voice over), " << audio.dropped() << " dropped\n";
+    std::cout << "voices busy: " << (double) busy / ticks << " on average, " << audio.mostBusyVoices() << " at most\n";
+    std::cout << "mix: " << mixMs / AUDIO_SECONDS << " ms per second of sound, " << realTime << "x real time (target " << AUDIO_TARGET << "x)\n";
+    std::cout << "checksum: " << std::hex << checksum << std::dec << "\n";
+
+    if (realTime < AUDIO_TARGET)
+    {
+        std::cout << "Error mixing is slower than its target.\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * Compares the cost of the simulation's vector math with floats vs fixed-point numbers.
+ * 
+ * Prints the timings, and a checksum of the fixed-point results (which should be the same on every machine).
+ * Returns the process exit code.
+ */
+int runMathBenchmark();
+
+/**
+ * Measures how many particles per millisecond the particle system can update and turn into vertices (no window needed).
+ * 
+ * Returns the process exit code: non-zero if it's slower than PARTICLE_TARGET.
+ */
+int runParticleBenchmark();
+
+/**
+ * Measures what mixing sound effects costs, offline (no audio device needed), with the voice pool as busy as the game
+ * can make it, and how many of the effects asked for got a voice.
+ * 
+ * Returns the process exit code: non-zero if it mixes less than AUDIO_TARGET times faster than real time.
+ */
+int runAudioBenchmark();
@@ -2,6 +2,7 @@
 
 #include "Vec2.h"
 #include <SFML/Graphics.hpp>
+#include <cstdint>
 
 class CTransform
 {
@@ -10,6 +11,9 @@ public:
     Vec2    velocity    = {0.0, 0.0};
     double  angle       = 0;
     float   angularVel  = 1.0f;
+    int     movedAt     = -1;   // movement tick pos is up to date for, -1 before it first moves (enemies far from the players only move every few ticks)
+    int     moveAt      = 0;    // movement tick it moves again at
+    int     spawnCell   = -1;   // spawn grid cell an enemy is counted in, -1 if it isn't
 
     CTransform(Vec2 p, Vec2 v, double a)
         : pos(p), velocity(v), angle(a) {}
@@ -18,9 +22,9 @@ public:
 class CCollision
 {
 public:
-    float radius = 0;
+    Real radius = 0;
 
-    CCollision(float r)
+    CCollision(Real r)
         : radius(r) {}
 };
 
@@ -37,6 +41,7 @@ class CShape
 {
 public:
     sf::CircleShape circle;
+    std::uint32_t   version = 0;    // goes up whenever a system changes the circle (see Entity::version())
 
     CShape(float radius, int points, const sf::Color & fill, const sf::Color & outline, float thickness)
         : circle(radius, points) 
@@ -53,6 +58,7 @@ class CLifespan
 public:
     int remaining   = 0;
     int total       = 0;
+    std::uint32_t version = 0;  // goes up whenever remaining goes down (see Entity::version())
 
     CLifespan(int total)
         : remaining(total), total(total) {}
@@ -66,6 +72,22 @@ public:
     bool right  = false;
     bool down   = false;
     bool shoot  = false;
+    int  player = 0;    // which player's controls drive this entity
 
     CInput() {}
+    CInput(int player)
+        : player(player) {}
+};
+
+class CBehaviour
+{
+public:
+    enum Type { SEEK, FLOCK, ORBIT, DODGE, TYPE_COUNT };
+
+    Type    type        = SEEK;
+    Vec2    steering    = {0.0, 0.0};   // added to the velocity every tick (worked out every few ticks, see Game::sAI())
+    int     thoughtAt   = -1;           // movement tick steering was worked out at (-1: not yet)
+
+    CBehaviour(Type t)
+        : type(t) {}
 };
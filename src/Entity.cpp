@@ -18,6 +18,34 @@ const std::string & Entity::tag() const
     return m_tag; 
 }
 
+// which components the entity has right now
+Signature Entity::signature() const
+{
+    return (cTransform ? signatureOf<CTransform>() : 0)
+        | (cShape     ? signatureOf<CShape>()     : 0)
+        | (cCollision ? signatureOf<CCollision>() : 0)
+        | (cInput     ? signatureOf<CInput>()     : 0)
+        | (cLifespan  ? signatureOf<CLifespan>()  : 0)
+        | (cScore     ? signatureOf<CScore>()     : 0)
+        | (cBehaviour ? signatureOf<CBehaviour>() : 0);
+}
+
+// changes whenever a system changes how the entity looks, apart from where it is and which way it's turned: its
+// CShape or CLifespan (the sum of their versions, which only ever go up). Consumers (the render thread's vertex cache)
+// keep the version they last saw, and reuse the entity's unrotated triangles while it's the same.
+std::uint32_t Entity::version() const
+{
+    return (cShape    ? cShape->version    : 0)
+        + (cLifespan ? cLifespan->version : 0);
+}
+
+// true if the entity has all the components in include, and none of the ones in exclude
+bool Entity::matches(Signature include, Signature exclude) const
+{
+    const Signature s = signature();
+    return (s & include) == include && (s & exclude) == 0;
+}
+
 void Entity::destroy() 
 { 
     m_active = false; 
@@ -4,6 +4,26 @@
 #include <memory>
 #include "Components.h"
 
+// Every component type has a bit, so the set of components an entity has (its signature) is a bitmask.
+// Asking for a type that isn't a component doesn't compile.
+typedef unsigned Signature;
+
+template <typename C> struct ComponentBit;
+template <> struct ComponentBit<CTransform> { static constexpr Signature value = 1 << 0; };
+template <> struct ComponentBit<CShape>     { static constexpr Signature value = 1 << 1; };
+template <> struct ComponentBit<CCollision> { static constexpr Signature value = 1 << 2; };
+template <> struct ComponentBit<CInput>     { static constexpr Signature value = 1 << 3; };
+template <> struct ComponentBit<CLifespan>  { static constexpr Signature value = 1 << 4; };
+template <> struct ComponentBit<CScore>     { static constexpr Signature value = 1 << 5; };
+template <> struct ComponentBit<CBehaviour> { static constexpr Signature value = 1 << 6; };
+
+// signatureOf<CTransform, CLifespan>() is the signature of an entity with just those components
+template <typename... Components>
+constexpr Signature signatureOf()
+{
+    return (Signature(0) | ... | ComponentBit<Components>::value);
+}
+
 class Entity
 {
 public:
@@ -13,10 +33,14 @@ public:
     std::shared_ptr<CInput>     cInput;
     std::shared_ptr<CLifespan>  cLifespan;
     std::shared_ptr<CScore>     cScore;
+    std::shared_ptr<CBehaviour> cBehaviour;
 
     bool isActive() const;
     const size_t id() const;
     const std::string & tag() const;
+    Signature signature() const;
+    std::uint32_t version() const;
+    bool matches(Signature include, Signature exclude) const;
     void destroy();
 
 private:
@@ -25,6 +49,7 @@ private:
     std::string m_tag    = "default";
     bool        m_active = true;
     size_t      m_id     = 0;
+    Signature   m_signature = 0;    // as of the last EntityManager::update()
 
     Entity(const std::string& tag, const size_t id);
 };
\ No newline at end of file
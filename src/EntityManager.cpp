@@ -1,4 +1,5 @@
 #include "EntityManager.h"
+#include "Alloc.h"
 #include <algorithm>
 
 std::shared_ptr<Entity> EntityManager::addEntity(const std::string& tag)
@@ -11,22 +12,105 @@ std::shared_ptr<Entity> EntityManager::addEntity(const std::string& tag)
 // removes dead entities & adds entities in wait list, should be called at begging of next frame (delayed affect)
 void EntityManager::update()
 {
+    // components may have been added or removed since the last update, then the cached views are rebuilt
+    // (in place, so they keep the memory they already have)
+    bool signaturesChanged = false;
+    for (auto e : m_entities)
+    {
+        const Signature signature = e->signature();
+        signaturesChanged = signaturesChanged || signature != e->m_signature;
+        e->m_signature = signature;
+    }
+    if (signaturesChanged)
+    {
+        rebuildViews();
+    }
+
     // add entities on wait list
+    m_added += m_toAdd.size();
     for (auto e : m_toAdd)
     {
+        e->m_signature = e->signature();
         m_entities.push_back(e);
         m_entityMap[e->tag()].push_back(e);
+
+        for (auto& v : m_views)
+        {
+            const std::string& tag = std::get<0>(v.first);
+            if ((tag.empty() || tag == e->tag()) && e->matches(std::get<1>(v.first), std::get<2>(v.first)))
+            {
+                v.second.push_back(e);
+            }
+        }
     }
     m_toAdd.clear();
 
     // remove 'destroyed' entities
     EntityVec::iterator it = std::remove_if(m_entities.begin(), m_entities.end(), [](const std::shared_ptr<Entity> e){ return !e->isActive(); });
+    m_removed += m_entities.end() - it;
     m_entities.erase(it, m_entities.end());
     for (auto& p : m_entityMap)
     {
         EntityVec::iterator it = std::remove_if(p.second.begin(), p.second.end(), [](const std::shared_ptr<Entity> e){ return !e->isActive(); });
         p.second.erase(it, p.second.end());
     }
+    for (auto& v : m_views)
+    {
+        EntityVec::iterator it = std::remove_if(v.second.begin(), v.second.end(), [](const std::shared_ptr<Entity> e){ return !e->isActive(); });
+        v.second.erase(it, v.second.end());
+    }
+}
+
+// refills every cached view from scratch (in place, so they keep the memory they already have)
+void EntityManager::rebuildViews()
+{
+    for (auto& v : m_views)
+    {
+        v.second.clear();
+        const std::string& tag = std::get<0>(v.first);
+        for (auto e : tag.empty() ? m_entities : getEntities(tag))
+        {
+            if (e->matches(std::get<1>(v.first), std::get<2>(v.first)))
+            {
+                v.second.push_back(e);
+            }
+        }
+    }
+}
+
+// returns the cached entities matching a query (built the first time it's asked for), see view()
+EntityVec& EntityManager::getView(const std::string& tag, Signature include, Signature exclude)
+{
+    const ViewKey key(tag, include, exclude);
+    auto found = m_views.find(key);
+    if (found != m_views.end())
+    {
+        return found->second;
+    }
+
+    // only the first time, so systems that must not allocate can still use views
+    alloc::AllowAlloc allowAlloc;
+
+    EntityVec& matches = m_views[key];
+    for (auto e : tag.empty() ? m_entities : getEntities(tag))
+    {
+        if (e->matches(include, exclude))
+        {
+            matches.push_back(e);
+        }
+    }
+    return matches;
+}
+
+// entities added & removed by update() so far (statistics, not copied by copyFrom())
+size_t EntityManager::totalAdded() const
+{
+    return m_added;
+}
+
+size_t EntityManager::totalRemoved() const
+{
+    return m_removed;
 }
 
 EntityVec& EntityManager::getEntities()
@@ -34,7 +118,69 @@ EntityVec& EntityManager::getEntities()
     return m_entities;
 }
 
+// (a tag nothing has had yet gets an empty list, without adding it to the map: looking up doesn't allocate)
 EntityVec& EntityManager::getEntities(const std::string& tag)
 {
-    return m_entityMap[tag];
+    auto found = m_entityMap.find(tag);
+    return found != m_entityMap.end() ? found->second : m_noEntities;
+}
+
+// returns the entity with the given id (including ones on the wait list), or nullptr if there is none
+std::shared_ptr<Entity> EntityManager::getEntity(size_t id)
+{
+    for (auto& e : m_entities)
+    {
+        if (e->id() == id)
+        {
+            return e;
+        }
+    }
+    for (auto& e : m_toAdd)
+    {
+        if (e->id() == id)
+        {
+            return e;
+        }
+    }
+    return nullptr;
+}
+
+// makes this a deep copy of other (entities and their components are copied, not shared), used to save & restore game state
+void EntityManager::copyFrom(const EntityManager& other)
+{
+    m_entities.clear();
+    m_toAdd.clear();
+    m_entityMap.clear();
+    m_totalEntities = other.m_totalEntities;
+
+    for (auto& e : other.m_entities)
+    {
+        auto copy = cloneEntity(*e);
+        m_entities.push_back(copy);
+        m_entityMap[copy->tag()].push_back(copy);
+    }
+    for (auto& e : other.m_toAdd)
+    {
+        m_toAdd.push_back(cloneEntity(*e));
+    }
+
+    // keep the cached views (a rollback loads a saved state every time, they'd be built from scratch each time otherwise)
+    rebuildViews();
+}
+
+std::shared_ptr<Entity> EntityManager::cloneEntity(const Entity & e)
+{
+    auto copy = std::shared_ptr<Entity>(new Entity(e.m_tag, e.m_id));
+    copy->m_active = e.m_active;
+    copy->m_signature = e.m_signature;
+
+    if (e.cTransform) { copy->cTransform = std::make_shared<CTransform>(*e.cTransform); }
+    if (e.cShape)     { copy->cShape     = std::make_shared<CShape>(*e.cShape); }
+    if (e.cCollision) { copy->cCollision = std::make_shared<CCollision>(*e.cCollision); }
+    if (e.cInput)     { copy->cInput     = std::make_shared<CInput>(*e.cInput); }
+    if (e.cLifespan)  { copy->cLifespan  = std::make_shared<CLifespan>(*e.cLifespan); }
+    if (e.cScore)     { copy->cScore     = std::make_shared<CScore>(*e.cScore); }
+    if (e.cBehaviour) { copy->cBehaviour = std::make_shared<CBehaviour>(*e.cBehaviour); }
+
+    return copy;
 }
@@ -1,3 +1,7 @@
+#pragma once
+
+#include <map>
+#include <tuple>
 #include <vector>
 #include <memory>
 #include "Entity.h"
@@ -5,17 +9,98 @@
 typedef std::vector<std::shared_ptr<Entity>> EntityVec;
 typedef std::map<std::string, EntityVec> EntityMap;
 
+// exclude<CLifespan>() passed to EntityManager::view() leaves out entities with those components
+template <typename... Components>
+struct Exclude
+{
+    static constexpr Signature value = signatureOf<Components...>();
+};
+
+template <typename... Components>
+constexpr Exclude<Components...> exclude()
+{
+    return Exclude<Components...>();
+}
+
+// The entities matching a query (see EntityManager::view()), for range-based for loops
+class EntityView
+{
+public:
+    class iterator
+    {
+    public:
+        iterator(EntityVec::iterator it, EntityVec::iterator end, Signature include, Signature exclude)
+            : m_it(it), m_end(end), m_include(include), m_exclude(exclude) { skip(); }
+
+        std::shared_ptr<Entity> & operator * () const { return *m_it; }
+        iterator & operator ++ () { ++m_it; skip(); return *this; }
+        bool operator != (const iterator & rhs) const { return m_it != rhs.m_it; }
+
+    private:
+        EntityVec::iterator m_it;
+        EntityVec::iterator m_end;
+        Signature           m_include;
+        Signature           m_exclude;
+
+        // The list is from the last update(), a component may have been added or removed since
+        void skip() { while (m_it != m_end && !(*m_it)->matches(m_include, m_exclude)) { ++m_it; } }
+    };
+
+    EntityView(EntityVec & entities, Signature include, Signature exclude)
+        : m_entities(entities), m_include(include), m_exclude(exclude) {}
+
+    iterator begin() const { return iterator(m_entities.begin(), m_entities.end(), m_include, m_exclude); }
+    iterator end() const { return iterator(m_entities.end(), m_entities.end(), m_include, m_exclude); }
+
+private:
+    EntityVec & m_entities;
+    Signature   m_include;
+    Signature   m_exclude;
+};
+
 class EntityManager
 {
     EntityVec m_entities;
     EntityVec m_toAdd;
     EntityMap m_entityMap;
+    EntityVec m_noEntities;     // always empty (see getEntities())
     size_t    m_totalEntities = 0;
+    size_t    m_added = 0;
+    size_t    m_removed = 0;
+
+    // Cached query results by (tag, "" for all entities; include; exclude), kept up to date by update()
+    typedef std::tuple<std::string, Signature, Signature> ViewKey;
+    std::map<ViewKey, EntityVec> m_views;
+
+    static std::shared_ptr<Entity> cloneEntity(const Entity & e);
+    EntityVec& getView(const std::string& tag, Signature include, Signature exclude);
+    void rebuildViews();
 
 public:
     EntityManager() {}
     void update(); 
     std::shared_ptr<Entity> addEntity(const std::string& tag);
+    std::shared_ptr<Entity> getEntity(size_t id);
     EntityVec& getEntities();
     EntityVec& getEntities(const std::string& tag);
-};
\ No newline at end of file
+    void copyFrom(const EntityManager& other);
+    size_t totalAdded() const;
+    size_t totalRemoved() const;
+
+    // view<CTransform, CLifespan>() is every entity with both a transform and a lifespan,
+    // view<CCollision>("enemy", exclude<CLifespan>()) is every enemy with a collision and no lifespan.
+    // The matching entities are cached, so iterating never looks at entities that don't match.
+    template <typename... Components, typename... Excluded>
+    EntityView view(Exclude<Excluded...> excluded = Exclude<Excluded...>())
+    {
+        return view<Components...>("", excluded);
+    }
+
+    template <typename... Components, typename... Excluded>
+    EntityView view(const std::string& tag, Exclude<Excluded...> = Exclude<Excluded...>())
+    {
+        constexpr Signature include = signatureOf<Components...>();
+        constexpr Signature exclude = Exclude<Excluded...>::value;
+        return EntityView(getView(tag, include, exclude), include, exclude);
+    }
+};
@@ -0,0 +1,50 @@
+#include "FastMath.h"
+
+namespace
+{
+    /**
+     * Sine of an angle in [0, pi/2] from its Taylor series (in double, so it is exact to float precision).
+     * 
+     * Used instead of std::sin so that the table can be built at compile time.
+     */
+    constexpr double taylorSin(double x)
+    {
+        double term = x;
+        double sum = x;
+        for (int n = 1; n < 15; n++)
+        {
+            term *= -x * x / ((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr std::array<float, fastmath::SIN_TABLE_SIZE> makeSinTable()
+    {
+        // Only the first quarter is computed, the rest is mirrored from it
+        const double pi = 3.14159265358979323846;
+        const std::size_t N = fastmath::SIN_TABLE_SIZE;
+        std::array<float, N> table = {};
+
+        for (std::size_t i = 0; i <= N / 4; i++)
+        {
+            const float s = static_cast<float>(taylorSin(2 * pi * i / N));
+            table[i] = s;                            // [0, 90]
+            table[(N / 2 - i) % N] = s;              // [90, 180]
+            table[(N / 2 + i) % N] = -s;             // [180, 270]
+            table[(N - i) % N] = i == 0 ? 0.0f : -s; // [270, 360)
+        }
+
+        return table;
+    }
+}
+
+const std::array<float, fastmath::SIN_TABLE_SIZE> fastmath::SIN_TABLE = makeSinTable();
+
+void fastmath::sincosDeg(const float * degrees, float * sines, float * cosines, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        sincosDeg(degrees[i], sines[i], cosines[i]);
+    }
+}
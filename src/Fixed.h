@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include "FastMath.h"
+
+/**
+ * Fixed-point number (48.16, stored in a 64 bit integer).
+ * 
+ * All math is integer math, so results are bit-identical on every machine and with every compiler flag
+ * (float math can change with -O3/-ffast-math contracting to FMA, x87 excess precision, and so on).
+ * Used for positions, velocities and radii when the game is built with GEOWARS_FIXED_POINT.
+ * 
+ * Range is about +-1.4e14 with a resolution of 1/65536, products and quotients are computed in 128 bits.
+ */
+class Fixed
+{
+public:
+    static const int          FRACTION_BITS = 16;
+    static const std::int64_t ONE           = std::int64_t(1) << FRACTION_BITS;
+
+    constexpr Fixed() {}
+
+    template <typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+    constexpr Fixed(I v)
+        : m_raw(static_cast<std::int64_t>(v) * ONE) {}
+
+    // Converting from float/double rounds to the nearest representable value
+    constexpr Fixed(double v)
+        : m_raw(static_cast<std::int64_t>(v * ONE + (v >= 0 ? 0.5 : -0.5))) {}
+    constexpr Fixed(float v)
+        : Fixed(static_cast<double>(v)) {}
+
+    static constexpr Fixed fromRaw(std::int64_t raw) { Fixed f; f.m_raw = raw; return f; }
+    constexpr std::int64_t raw() const { return m_raw; }
+
+    explicit constexpr operator float () const { return static_cast<float>(m_raw) / ONE; }
+    explicit constexpr operator double() const { return static_cast<double>(m_raw) / ONE; }
+    explicit constexpr operator int   () const { return static_cast<int>(m_raw >> FRACTION_BITS); }
+
+    friend constexpr Fixed operator - (Fixed a) { return fromRaw(-a.m_raw); }
+    friend constexpr Fixed operator + (Fixed a, Fixed b) { return fromRaw(a.m_raw + b.m_raw); }
+    friend constexpr Fixed operator - (Fixed a, Fixed b) { return fromRaw(a.m_raw - b.m_raw); }
+    friend constexpr Fixed operator * (Fixed a, Fixed b) { return fromRaw(static_cast<std::int64_t>((static_cast<__int128>(a.m_raw) * b.m_raw) >> FRACTION_BITS)); }
+    friend constexpr Fixed operator / (Fixed a, Fixed b) { return fromRaw(static_cast<std::int64_t>((static_cast<__int128>(a.m_raw) << FRACTION_BITS) / b.m_raw)); }
+
+    constexpr Fixed& operator += (Fixed rhs) { return *this = *this + rhs; }
+    constexpr Fixed& operator -= (Fixed rhs) { return *this = *this - rhs; }
+    constexpr Fixed& operator *= (Fixed rhs) { return *this = *this * rhs; }
+    constexpr Fixed& operator /= (Fixed rhs) { return *this = *this / rhs; }
+
+    friend constexpr bool operator == (Fixed a, Fixed b) { return a.m_raw == b.m_raw; }
+    friend constexpr bool operator != (Fixed a, Fixed b) { return a.m_raw != b.m_raw; }
+    friend constexpr bool operator <  (Fixed a, Fixed b) { return a.m_raw <  b.m_raw; }
+    friend constexpr bool operator >  (Fixed a, Fixed b) { return a.m_raw >  b.m_raw; }
+    friend constexpr bool operator <= (Fixed a, Fixed b) { return a.m_raw <= b.m_raw; }
+    friend constexpr bool operator >= (Fixed a, Fixed b) { return a.m_raw >= b.m_raw; }
+
+private:
+    std::int64_t m_raw = 0;
+};
+
+/**
+ * Square root (rounded down to the nearest representable value). Negative numbers give 0.
+ */
+inline Fixed sqrt(Fixed v)
+{
+    if (v.raw() <= 0)
+    {
+        return Fixed();
+    }
+
+    // sqrt(raw / ONE) * ONE == sqrt(raw * ONE), found bit by bit
+    const unsigned __int128 n = static_cast<unsigned __int128>(v.raw()) << Fixed::FRACTION_BITS;
+    unsigned __int128 remainder = n;
+    unsigned __int128 root = 0;
+    unsigned __int128 bit = static_cast<unsigned __int128>(1) << 126;
+
+    while (bit > n)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (remainder >= root + bit)
+        {
+            remainder -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return Fixed::fromRaw(static_cast<std::int64_t>(root));
+}
+
+/**
+ * Sine and cosine of an angle in degrees, using the same table as fastmath::sincosDeg() but interpolating with
+ * integer math only.
+ * 
+ * degrees - angle in degrees
+ * s       - gets the sine of the angle
+ * c       - gets the cosine of the angle
+ */
+inline void sincosDeg(Fixed degrees, Fixed & s, Fixed & c)
+{
+    const std::int64_t MASK = fastmath::SIN_TABLE_SIZE - 1;
+    const std::int64_t QUARTER = fastmath::SIN_TABLE_SIZE / 4;
+
+    // Position in the table, in 16.16 (the shift floors negative angles too)
+    const std::int64_t t = static_cast<std::int64_t>((static_cast<__int128>(degrees.raw()) * fastmath::SIN_TABLE_SIZE) / 360);
+    const std::int64_t i = t >> Fixed::FRACTION_BITS;
+    const std::int64_t frac = t & (Fixed::ONE - 1);
+
+    const std::int64_t si = i & MASK;
+    const std::int64_t ci = (si + QUARTER) & MASK;
+
+    // Table entries are floats, but converting them is exact and doesn't depend on the machine
+    const std::int64_t s0 = Fixed(fastmath::SIN_TABLE[si]).raw();
+    const std::int64_t s1 = Fixed(fastmath::SIN_TABLE[(si + 1) & MASK]).raw();
+    const std::int64_t c0 = Fixed(fastmath::SIN_TABLE[ci]).raw();
+    const std::int64_t c1 = Fixed(fastmath::SIN_TABLE[(ci + 1) & MASK]).raw();
+
+    s = Fixed::fromRaw(s0 + (((s1 - s0) * frac) >> Fixed::FRACTION_BITS));
+    c = Fixed::fromRaw(c0 + (((c1 - c0) * frac) >> Fixed::FRACTION_BITS));
+}
+
+/**
+ * Batch version of sincosDeg() for fixed-point angles.
+ */
+inline void sincosDeg(const Fixed * degrees, Fixed * sines, Fixed * cosines, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        sincosDeg(degrees[i], sines[i], cosines[i]);
+    }
+}
+
+/**
+ * Converts a simulation number to float (for SFML, which only knows floats).
+ */
+inline float toFloat(float v) { return v; }
+inline float toFloat(Fixed v) { return static_cast<float>(v); }
+
+// The number type used by the simulation (positions, velocities, radii)
+#ifdef GEOWARS_FIXED_POINT
+typedef Fixed Real;
+#else
+typedef float Real;
+#endif
@@ -0,0 +1,148 @@
+#include "FlowField.h"
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+/**
+ * threads - threads to build the field with (0 means one per CPU core)
+ */
+FlowField::FlowField(int threads)
+    : m_threads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+/**
+ * Builds the field again if any target is in another cell than when it was last built (or the area changed).
+ * Returns true if it did.
+ * 
+ * targetX     - the targets' x positions
+ * targetY     - the targets' y positions
+ * targetCount - how many targets there are (with none, every direction is 0)
+ * width       - width of the area, from 0
+ * height      - height of the area, from 0
+ * cellSize    - size of a cell
+ */
+bool FlowField::update(const float * targetX, const float * targetY, int targetCount, float width, float height, float cellSize)
+{
+    const int cols = std::max(1, (int) std::ceil(width / cellSize));
+    const int rows = std::max(1, (int) std::ceil(height / cellSize));
+
+    bool changed = cols != m_cols || rows != m_rows || cellSize != m_cellSize || targetCount != (int) m_targetCells.size();
+    m_targetCells.resize(targetCount);
+    m_targetX.resize(targetCount);
+    m_targetY.resize(targetCount);
+    for (int t = 0; t < targetCount; t++)
+    {
+        const int col = std::min(cols - 1, std::max(0, (int) (targetX[t] / cellSize)));
+        const int row = std::min(rows - 1, std::max(0, (int) (targetY[t] / cellSize)));
+        changed = changed || m_targetCells[t] != row * cols + col;
+        m_targetCells[t] = row * cols + col;
+
+        // Distances are to the middle of the target's cell (so the field only changes when a target changes cell)
+        m_targetX[t] = (col + 0.5f) * cellSize;
+        m_targetY[t] = (row + 0.5f) * cellSize;
+    }
+
+    if (!changed)
+    {
+        return false;
+    }
+
+    m_cols = cols;
+    m_rows = rows;
+    m_cellSize = cellSize;
+    m_distance.resize(cols * rows);
+    m_dirX.resize(cols * rows);
+    m_dirY.resize(cols * rows);
+
+    // Directions need the distances of the rows above and below, so all distances come first
+    forEachRow([this](int row) { distanceRow(row); });
+    forEachRow([this](int row) { directionRow(row); });
+
+    m_builds++;
+    return true;
+}
+
+/**
+ * Runs work(row) for every row, shared out between the threads (rows are taken one at a time until there are none left).
+ */
+template <typename Work>
+void FlowField::forEachRow(Work work)
+{
+    std::atomic<int> nextRow { 0 };
+    auto rows = [this, &nextRow, &work]()
+    {
+        for (int row = nextRow++; row < m_rows; row = nextRow++)
+        {
+            work(row);
+        }
+    };
+
+    const int threads = m_cols * m_rows >= PARALLEL_CELLS ? std::min(m_threads, m_rows) : 1;
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threads; i++)
+    {
+        helpers.emplace_back(rows);
+    }
+    rows();
+    for (std::thread & helper : helpers)
+    {
+        helper.join();
+    }
+}
+
+/**
+ * Works out a row's distances to the nearest target (from each cell's middle).
+ */
+void FlowField::distanceRow(int row)
+{
+    float * distance = &m_distance[row * m_cols];
+    const float y = (row + 0.5f) * m_cellSize;
+
+    // Squared first (the nearest target is the one with the smallest), then the square root, one pass each
+    for (int col = 0; col < m_cols; col++)
+    {
+        distance[col] = m_targetCells.empty() ? 0.0f : INFINITY;
+    }
+    for (size_t t = 0; t < m_targetCells.size(); t++)
+    {
+        const float dy = y - m_targetY[t];
+        const float dySquared = dy * dy;
+        const float tx = m_targetX[t];
+        for (int col = 0; col < m_cols; col++)
+        {
+            const float dx = (col + 0.5f) * m_cellSize - tx;
+            distance[col] = std::min(distance[col], dx * dx + dySquared);
+        }
+    }
+    for (int col = 0; col < m_cols; col++)
+    {
+        distance[col] = std::sqrt(distance[col]);
+    }
+}
+
+/**
+ * Works out a row's directions: downhill (the distance's slope, from the cells on each side, or the cell itself at
+ * the edges), length 1.
+ */
+void FlowField::directionRow(int row)
+{
+    const float * distance = &m_distance[row * m_cols];
+    const float * above = &m_distance[std::max(0, row - 1) * m_cols];
+    const float * below = &m_distance[std::min(m_rows - 1, row + 1) * m_cols];
+    float * dirX = &m_dirX[row * m_cols];
+    float * dirY = &m_dirY[row * m_cols];
+
+    for (int col = 0; col < m_cols; col++)
+    {
+        const float left = distance[std::max(0, col - 1)];
+        const float right = distance[std::min(m_cols - 1, col + 1)];
+        const float gx = left - right;
+        const float gy = above[col] - below[col];
+        const float length = std::sqrt(gx * gx + gy * gy);
+        const float scale = length > 0 ? 1 / length : 0;
+        dirX[col] = gx * scale;
+        dirY[col] = gy * scale;
+    }
+}
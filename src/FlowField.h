@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * Flow field: for every cell of a grid over the play area, which way to go to get to the nearest target (the players).
+ * 
+ * Built once for everyone that's after the targets, and only again when a target moves to another cell, so any
+ * number of chasers each just look up their cell (direction()). The distance to the nearest target is worked out
+ * for every cell, and the direction is downhill from it. There are no obstacles in the game, so a cell's distance
+ * doesn't depend on any other cell's (it's the straight line, what a search around obstacles would come up with when
+ * there aren't any): rows are independent, so they're shared out between threads, and each row is a plain loop the
+ * compiler vectorises.
+ */
+class FlowField
+{
+public:
+    FlowField(int threads = 0);
+
+    bool update(const float * targetX, const float * targetY, int targetCount, float width, float height, float cellSize);
+
+    /**
+     * Sets (dx, dy) to the way to go from (x, y): length 1, or 0 in a target's cell (and before the field is built).
+     */
+    void direction(float x, float y, float & dx, float & dy) const
+    {
+        if (m_cols == 0)
+        {
+            dx = dy = 0;
+            return;
+        }
+        const int col = std::min(m_cols - 1, std::max(0, (int) (x / m_cellSize)));
+        const int row = std::min(m_rows - 1, std::max(0, (int) (y / m_cellSize)));
+        dx = m_dirX[row * m_cols + col];
+        dy = m_dirY[row * m_cols + col];
+    }
+
+    int cols() const { return m_cols; }
+    int rows() const { return m_rows; }
+    long builds() const { return m_builds; }
+
+private:
+    static const int PARALLEL_CELLS = 16 * 1024;   // fields smaller than this are built on one thread (starting threads costs more)
+
+    int                 m_threads;
+    int                 m_cols          = 0;
+    int                 m_rows          = 0;
+    float               m_cellSize      = 1;
+    long                m_builds        = 0;
+    std::vector<int>    m_targetCells;              // cells the targets were in when the field was last built
+    std::vector<float>  m_targetX;
+    std::vector<float>  m_targetY;
+    std::vector<float>  m_distance;                 // per cell, row by row
+    std::vector<float>  m_dirX;
+    std::vector<float>  m_dirY;
+
+    void distanceRow(int row);
+    void directionRow(int row);
+    template <typename Work> void forEachRow(Work work);
+};
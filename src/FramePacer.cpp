@@ -0,0 +1,168 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <thread>
+
+/**
+ * Sets how frames are paced.
+ * 
+ * mode - how to wait for the next frame
+ * fps  - target frames per second (also what missed deadlines are counted against)
+ */
+void FramePacer::setMode(Mode mode, double fps)
+{
+    m_mode = mode;
+    m_period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+    m_started = false;
+}
+
+FramePacer::Mode FramePacer::mode() const
+{
+    return m_mode;
+}
+
+/**
+ * Waits until it's time to present the next frame (call right before display()).
+ */
+void FramePacer::wait()
+{
+    if (m_mode != FIXED)
+    {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    if (!m_started)
+    {
+        m_deadline = now;
+    }
+
+    // Coarse sleep, then spin for the last bit (sleeping is only accurate to about a millisecond)
+    if (m_deadline - now > m_spin)
+    {
+        const Clock::time_point wake = m_deadline - m_spin;
+        std::this_thread::sleep_until(wake);
+        now = Clock::now();
+
+        // Overslept far into the spin time: leave more room next time. Woke up early: spin a little less.
+        const Clock::duration overslept = now - wake;
+        if (overslept > m_spin / 2)
+        {
+            m_spin = std::min<Clock::duration>(m_spin * 2, m_period / 2);
+        }
+        else if (overslept < m_spin / 4)
+        {
+            m_spin = std::max<Clock::duration>(m_spin - m_spin / 16, std::chrono::microseconds(500));
+        }
+    }
+    while (now < m_deadline)
+    {
+        now = Clock::now();
+    }
+
+    // A late frame starts a new schedule (instead of rushing the next frames to catch up)
+    m_deadline = std::max(m_deadline, now - m_period) + m_period;
+}
+
+/**
+ * Records that a frame was presented (call right after display()).
+ */
+void FramePacer::presented()
+{
+    const Clock::time_point now = Clock::now();
+
+    if (m_started)
+    {
+        const double ms = std::chrono::duration<double, std::milli>(now - m_lastPresent).count();
+        const double targetMs = std::chrono::duration<double, std::milli>(m_period).count();
+
+        m_histogram[std::min(BUCKETS - 1, (int) (ms / BUCKET_MS))]++;
+        m_frames++;
+        m_missed += ms > targetMs + MISS_SLACK_MS ? 1 : 0;
+        m_worstMs = std::max(m_worstMs, ms);
+    }
+
+    m_started = true;
+    m_lastPresent = now;
+}
+
+/**
+ * Returns how many frame times have been recorded.
+ */
+long FramePacer::frames() const
+{
+    return m_frames;
+}
+
+/**
+ * Returns how many frames missed their deadline.
+ */
+long FramePacer::missed() const
+{
+    return m_missed;
+}
+
+/**
+ * Prints the frame time histogram (only the buckets with frames in them) and the missed deadlines.
+ * 
+ * out - where to print
+ */
+void FramePacer::print(std::ostream & out) const
+{
+    const double targetMs = std::chrono::duration<double, std::milli>(m_period).count();
+
+    out << "Frame pacing: " << modeName(m_mode) << ", target " << std::fixed << std::setprecision(2) << targetMs << " ms, "
+        << m_frames << " frames, " << m_missed << " missed deadlines, worst " << m_worstMs << " ms\n";
+
+    long most = 1;
+    for (int i = 0; i < BUCKETS; i++)
+    {
+        most = std::max(most, m_histogram[i]);
+    }
+
+    for (int i = 0; i < BUCKETS; i++)
+    {
+        if (m_histogram[i] == 0)
+        {
+            continue;
+        }
+
+        out << "  " << std::setw(5) << i * BUCKET_MS << " - ";
+        if (i == BUCKETS - 1)
+        {
+            out << "     ";
+        }
+        else
+        {
+            out << std::setw(5) << (i + 1) * BUCKET_MS;
+        }
+        out << " ms " << std::setw(8) << m_histogram[i] << " " << std::string((size_t) (40 * m_histogram[i] / most), '#') << "\n";
+    }
+
+    out << std::defaultfloat << std::setprecision(6);
+}
+
+const char * FramePacer::modeName(Mode mode)
+{
+    static const char * const NAMES[MODE_COUNT] = { "vsync", "fixed", "uncapped" };
+    return mode < MODE_COUNT ? NAMES[mode] : "?";
+}
+
+/**
+ * Gets a mode from its name (as given by modeName()).
+ * 
+ * Returns false if there is no mode with that name.
+ */
+bool FramePacer::parseMode(const std::string & name, Mode & mode)
+{
+    for (int i = 0; i < MODE_COUNT; i++)
+    {
+        if (name == modeName((Mode) i))
+        {
+            mode = (Mode) i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+/**
+ * Paces frames to a steady rate, and keeps a histogram of how long frames actually took.
+ * 
+ * FIXED sleeps until shortly before each frame's deadline and spins for the rest, so frames start within a few
+ * microseconds of it (a plain sleep can overshoot by a millisecond or more). VSYNC leaves the waiting to the driver
+ * (the window has to have vsync enabled), and UNCAPPED doesn't wait at all. In every mode a frame that takes more
+ * than MISS_SLACK_MS longer than the target frame time counts as a missed deadline.
+ */
+class FramePacer
+{
+public:
+    enum Mode { VSYNC, FIXED, UNCAPPED, MODE_COUNT };
+
+    static constexpr double BUCKET_MS       = 0.5;  // histogram bucket width
+    static const int        BUCKETS         = 100;  // the last one also counts everything longer
+    static constexpr double MISS_SLACK_MS   = 1.0;
+
+    void setMode(Mode mode, double fps);
+    Mode mode() const;
+
+    void wait();
+    void presented();
+
+    long frames() const;
+    long missed() const;
+    void print(std::ostream & out) const;
+
+    static const char * modeName(Mode mode);
+    static bool parseMode(const std::string & name, Mode & mode);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Mode                m_mode          = FIXED;
+    Clock::duration     m_period        = std::chrono::nanoseconds(1000000000 / 60);
+    Clock::duration     m_spin          = std::chrono::milliseconds(2);    // how long before the deadline to stop sleeping (grows if sleeps overshoot)
+    Clock::time_point   m_deadline;
+    Clock::time_point   m_lastPresent;
+    bool                m_started       = false;
+    long                m_histogram[BUCKETS] = {};
+    long                m_frames        = 0;
+    long                m_missed        = 0;
+    double              m_worstMs       = 0;
+};
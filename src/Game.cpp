@@ -1,382 +1,886 @@
 #include "Game.h"
+#include "FastMath.h"
+#include "Alloc.h"
+#include "Assets.h"
+#include "SoftwareRenderer.h"
 
 #include <cstdlib>
+#include <iomanip>
 #include <iostream>
 #include <cmath>
 #include <sstream>
+#include <algorithm>
+#include <ctime>
+#include <future>
+#include <thread>
 
 
 /**
- * Returns a random number within the given range.
+ * Returns the settings of the simulation a game with these settings plays.
  * 
- * The range is from min (included) to max (included).
+ * Netplay and headless games must play the same every time (both netplay games make the same random choices, and
+ * the same headless settings always give the same image), so they think a fixed amount a tick and share a seed.
  */
-int randFromRange(int min, int max)
+SimConfig simConfigFor(const NetConfig & netConfig, const RenderConfig & renderConfig)
 {
-    return (rand() % (1 + max - min)) + min;
+    SimConfig simConfig;
+    simConfig.SEED = netConfig.SEED;
+    simConfig.PLAYERS = netConfig.ENABLED ? MAX_PLAYERS : 1;
+    simConfig.PLAYER = netConfig.PLAYER;
+    simConfig.DETERMINISTIC = netConfig.ENABLED || renderConfig.HEADLESS;
+    return simConfig;
 }
 
 /**
- * Checks if two circles are overlapping.
- * 
- * Use this function instead of overlap() if all you need to known is if two circles overlap
- * because it is more efficient at doing this calculation.
+ * Creates instance of Game and initializes it.
  * 
- * pos1 - center of circle 1
- * pos2 - center of circle 2
- * r1   - radius of circle 1
- * r2   - radius of circle 2
+ * netConfig    - netplay settings (netplay is off by default)
+ * renderConfig - headless (software rendered) mode settings (off by default)
+ * worldConfig  - size of the world (the window's size by default)
  */
-bool isOverlap(Vec2 pos1, Vec2 pos2, float r1, float r2)
+Game::Game(const NetConfig & netConfig, const RenderConfig & renderConfig, const WorldConfig & worldConfig, const AudioConfig & audioConfig)
+    : GameSim(simConfigFor(netConfig, renderConfig), worldConfig)
+    , m_netConfig(netConfig)
+    , m_renderConfig(renderConfig)
+    , m_audioConfig(audioConfig)
+    , m_startTime(std::chrono::steady_clock::now())
+    , m_audio(audioConfig, renderConfig.HEADLESS)
 {
-    // Apparently, calculating the square root of a number is very expensive. So instead we just compare distances squared.
-    return pos1.distSqr(pos2) < (r1 + r2) * (r1 + r2);
+    // Single player starts in the start menu
+    m_startMenu = !m_netConfig.ENABLED;
+
+    init();
 }
 
 /**
- * Returns the overlap or distance between the two circles.
- * 
- * If the overlap is greater than 0, then the returned value is the overlap of the two circles.
+ * Runs the game.
  * 
- * If the overlap is less then or equal to 0, then it means the two circles are not overlapping,
- * and the absolute value of this overlap is the distance between the two circles. To be specific,
- * this distance is the distance between the two centers of the circles minus both their radiuses.
+ * The simulation runs on its own thread, and this thread renders (and handles the window). They only talk
+ * through lock-free buffers (render snapshots one way, window events the other), so neither ever waits for
+ * the other: a slow frame doesn't slow the simulation down, and a slow tick doesn't stall rendering.
  * 
- * pos1 - center of circle 1
- * pos2 - center of circle 2
- * r1   - radius of circle 1
- * r2   - radius of circle 2
+ * Returns the process exit code.
  */
-float overlap(Vec2 pos1, Vec2 pos2, float r1, float r2)
+int Game::run()
 {
-    return (r1 + r2) - pos1.dist(pos2);
+    if (m_renderConfig.HEADLESS)
+    {
+        return runHeadless();
+    }
+
+    // Spawn 1 enemy for start menu scene so that it bounces and moves around in the background
+    spawnEnemy();
+
+    // Each netplay game gets its own counters
+    m_perf.open(m_netConfig.ENABLED ? PERF_SEGMENT + std::string("-") + std::to_string(m_netConfig.PLAYER) : PERF_SEGMENT);
+
+    std::thread simulation(&Game::simulationLoop, this);
+    renderLoop();
+    simulation.join();
+
+    // Close window
+    m_window.close();
+
+    // Input latency (from when the render thread took the event from the window)
+    if (m_inputSimulatedLatency.count() > 0)
+    {
+        std::cout << "Input latency (ms):\n";
+        m_inputSimulatedLatency.print(std::cout, "  event -> simulated");
+        m_inputPresentedLatency.print(std::cout, "  event -> presented");
+    }
+
+    // Frame budget governor
+    std::cout << "Quality level: " << FrameGovernor::levelName(m_governor.level()) << " (budget used: " << (int) (m_governor.pressure() * 100) << "%)\n";
+    for (int level = 0; level < FrameGovernor::LEVEL_COUNT; level++)
+    {
+        std::cout << "  ticks at " << FrameGovernor::levelName((FrameGovernor::Level) level) << ": " << m_governor.ticksAt((FrameGovernor::Level) level) << "\n";
+    }
+    std::cout << "Cost per tick (ms):\n";
+    for (int system = 0; system < FrameGovernor::SYSTEM_COUNT; system++)
+    {
+        std::cout << "  " << FrameGovernor::systemName((FrameGovernor::System) system) << ": " << m_governor.cost((FrameGovernor::System) system) << "\n";
+    }
+
+    // Allocations
+    std::cout << "Allocations per tick (per frame for render):\n";
+    for (int system = 0; system < FrameGovernor::SYSTEM_COUNT; system++)
+    {
+        const double per = std::max(1L, system == FrameGovernor::RENDER ? m_renderFrame : m_simulatedTicks);
+        std::cout << "  " << FrameGovernor::systemName((FrameGovernor::System) system) << ": " << m_systemAllocations[system] / per
+                  << " (" << m_systemAllocatedBytes[system] / per << " bytes)\n";
+    }
+    if (alloc::violations() > 0)
+    {
+        std::cout << "Allocations inside no-allocation regions: " << alloc::violations() << "\n";
+    }
+
+    // Frame times
+    m_pacer.print(std::cout);
+    return 0;
 }
 
 /**
- * Creates instance of Game and initializes it.
+ * Plays a scripted game without a window for a number of ticks, and saves the last frame (software rendered).
+ * 
+ * Everything happens on this thread, one frame per tick, and the game is seeded, so the same settings always give
+ * the same image (its checksum is printed, for comparing against a known good one).
+ * 
+ * Returns the process exit code: non-zero if the image couldn't be saved, or isn't the one RenderConfig's EXPECT says.
  */
-Game::Game()
+int Game::runHeadless()
 {
-    init();
+    SoftwareRenderer renderer(m_windowConfig.W, m_windowConfig.H, m_renderConfig.THREADS);
+    if (!renderer.loadFont(assets::fontData(), assets::fontSize()))
+    {
+        std::cout << "Error with loading font.\n";
+    }
+
+    m_startMenu = false;
+
+    // Stress test: enemies all over the world (most of them out of view)
+    if (m_renderConfig.ENEMIES > 0)
+    {
+        spawnEnemy(m_renderConfig.ENEMIES);
+        m_entities.update();
+    }
+
+    double simulateMs = 0;
+    size_t shapesDrawn = 0;
+    size_t shapesRebuilt = 0;
+    double drawListMs = 0;
+    double rasteriseMs = 0;
+
+    // Sound is mixed offline, a tick's worth at a time (its checksum is printed too: the same game sounds the same)
+    std::vector<std::int16_t> mixed(m_audioConfig.RATE / m_windowConfig.TR);
+    double mixMs = 0;
+    std::uint64_t audioChecksum = 14695981039346656037ull;
+
+    for (int frame = 0; frame < m_renderConfig.TICKS; frame++)
+    {
+        m_localInput = botInput(frame, m_renderConfig.TICKS * 2 / 3);
+
+        Stopwatch stopwatch;
+        tick();
+        publishSnapshot();
+        simulateMs += stopwatch.lap();
+
+        m_snapshots.update();
+        const RenderSnapshot & snapshot = m_snapshots.readBuffer();
+        updateParticles(snapshot, 1.0f / m_windowConfig.TR);
+        shapesDrawn += snapshot.shapes.size();
+
+        // Only the last frame is rasterised, but the draw list is built every frame (to profile it)
+        buildDrawList(snapshot, renderer);
+        shapesRebuilt += m_shapesRebuilt;
+        drawListMs += stopwatch.lap();
+
+        playSounds(0);
+        m_audio.mix(mixed.data(), mixed.size());
+        mixMs += stopwatch.lap();
+        for (std::int16_t sample : mixed)
+        {
+            audioChecksum = (audioChecksum ^ (std::uint16_t) sample) * 1099511628211ull;
+        }
+
+        if (frame + 1 == m_renderConfig.TICKS)
+        {
+            renderer.finish();
+            rasteriseMs += stopwatch.lap();
+        }
+    }
+
+    const bool saved = renderer.save(m_renderConfig.OUTPUT);
+    if (!saved)
+    {
+        std::cout << "Error with saving " << m_renderConfig.OUTPUT << ".\n";
+    }
+
+    std::cout << "ticks: " << m_renderConfig.TICKS << ", seed: " << m_netConfig.SEED << ", entities: " << m_entities.getEntities().size() << ", particles: " << m_particles.liveCount() << "\n";
+    std::cout << "world: " << m_worldConfig.W << "x" << m_worldConfig.H << ", shapes in view: " << shapesDrawn / m_renderConfig.TICKS << " per frame\n";
+    std::cout << "flow field: " << m_flowField.cols() << "x" << m_flowField.rows() << " cells, built " << m_flowField.builds() << " times\n";
+    std::cout << "simulate: " << simulateMs / m_renderConfig.TICKS << " ms/tick\n";
+    std::cout << "draw list: " << drawListMs / m_renderConfig.TICKS << " ms/frame, shape cache: " << shapesRebuilt << " of " << shapesDrawn
+              << " shapes made again (" << 100.0 * (shapesDrawn - shapesRebuilt) / std::max<size_t>(1, shapesDrawn) << "% reused)\n";
+    std::cout << "rasterise: " << rasteriseMs << " ms (" << m_renderConfig.THREADS << " threads, 0 is one per core)\n";
+    std::cout << "audio: " << m_audio.played() << " effects played (" << m_audio.stolen() << " took a voice over), " << m_audio.dropped() << " dropped, most voices at once: "
+              << m_audio.mostBusyVoices() << " of " << m_audio.voices() << ", mixing: " << mixMs / m_renderConfig.TICKS << " ms/tick, checksum: " << std::hex << audioChecksum << std::dec << "\n";
+    std::cout << "image: " << m_renderConfig.OUTPUT << ", checksum: " << std::hex << renderer.checksum() << std::dec << "\n";
+
+    if (!m_renderConfig.EXPECT.empty() && std::strtoull(m_renderConfig.EXPECT.c_str(), nullptr, 16) != renderer.checksum())
+    {
+        std::cout << "Error image checksum isn't the known good one (" << m_renderConfig.EXPECT << ").\n";
+        return 1;
+    }
+    return saved ? 0 : 1;
 }
 
 /**
- * Runs the main game loop.
+ * Gives the software renderer what sRender() draws for the snapshot: entities, particles, and the scene's HUD or menu
+ * (its text, overlay and lines, placed the same way). The pause overlay is left out (a scripted game never pauses).
+ * 
+ * snapshot - what to draw
+ * renderer - where to draw it
  */
-void Game::run()
+void Game::buildDrawList(const RenderSnapshot & snapshot, SoftwareRenderer & renderer)
 {
-    // Spawn 1 enemy for start menu scene so that it bounces and moves around in the background
-    spawnEnemy();
+    renderer.clear(sf::Color::Black);
 
-    // While game is running
-    while (m_running)
+    // The world is drawn through the camera (the software renderer has no views, so vertices are moved instead)
+    const sf::Vector2f camera(snapshot.cameraX, snapshot.cameraY);
+
+    const std::vector<sf::Vertex> & entityVertices = buildEntityVertices(snapshot);
+    m_shapeVertices.assign(entityVertices.begin(), entityVertices.end());
+    for (sf::Vertex & vertex : m_shapeVertices)
     {
-        m_entities.update();
+        vertex.position = vertex.position - camera;
+    }
+    renderer.drawTriangles(m_shapeVertices.data(), m_shapeVertices.size());
 
-        // Start menu scene
-        if (m_startMenu)
+    if (snapshot.scene != RenderSnapshot::START_MENU)
+    {
+        // (particle vertices are made again every frame, so they can be moved in place)
+        for (sf::Vertex & vertex : m_particleVertices)
         {
-            sRender();
-            sUserInput();
-            sMovement();
+            vertex.position = vertex.position - camera;
         }
-        else if (m_endGameMenu)
+        renderer.drawLines(m_particleVertices.data(), m_particleVertices.size(), SoftwareRenderer::ADD);
+    }
+
+    const float W = m_windowConfig.W;
+    const float H = m_windowConfig.H;
+
+    // sf::RectangleShape
+    auto rectangle = [this, &renderer](float x, float y, float width, float height, const sf::Color & color)
+    {
+        const sf::Vertex topLeft(sf::Vector2f(x, y), color);
+        const sf::Vertex topRight(sf::Vector2f(x + width, y), color);
+        const sf::Vertex bottomRight(sf::Vector2f(x + width, y + height), color);
+        const sf::Vertex bottomLeft(sf::Vector2f(x, y + height), color);
+        m_shapeVertices.assign({ topLeft, topRight, bottomRight, topLeft, bottomRight, bottomLeft });
+        renderer.drawTriangles(m_shapeVertices.data(), m_shapeVertices.size());
+    };
+    // sf::Text with its origin at its bounds' top left (as sRender() sets it), so x & y are where the text's top left is
+    auto text = [&renderer](const std::string & string, const sf::FloatRect & bounds, float x, float y, unsigned size, const sf::Color & color)
+    {
+        renderer.drawText(string, x - bounds.left, y - bounds.top, size, color);
+    };
+
+    if (snapshot.scene == RenderSnapshot::START_MENU)
+    {
+        // Semi-transparent background (overlayed over enemies in background)
+        rectangle(0, 0, W, H, sf::Color(50, 50, 50, 120));
+
+        // Main title (game name), and the line under it
+        const std::string title = "Geometry Wars";
+        const sf::FloatRect titleBounds = renderer.textBounds(title, 50);
+        const float titleY = H/2 - titleBounds.height/2;
+        text(title, titleBounds, W/2 - titleBounds.width/2, titleY, 50, sf::Color::Cyan);
+        rectangle(0, titleY + titleBounds.height + 8, W, 1, sf::Color::Cyan);
+
+        // How to start game instruction (blinks)
+        const std::string enterGame = "press enter to play";
+        const sf::FloatRect enterGameBounds = renderer.textBounds(enterGame, 16);
+        text(enterGame, enterGameBounds, W/2 - enterGameBounds.width/2, titleY + titleBounds.height + 30, 16, sf::Color(255, 255, 255, 255*snapshot.blinkAlpha));
+
+        // Key mappings guide
+        const char * keys[] = { "W - up", "A - left", "S - down", "D - right", "LEFT CLICK - main weapon", "RIGHT CLICK - special weapon", "P - pause/unpause" };
+        float keyY = 10;
+        for (const char * key : keys)
         {
-            sUserInput();
-            sMovement();
-            sCollision();
-            sLifespan();
-            sRender();
+            const sf::FloatRect keyBounds = renderer.textBounds(key, 12);
+            text(key, keyBounds, 10, keyY, 12, sf::Color::White);
+            keyY += keyBounds.height + 10;
         }
-        // Pause scene
-        else if (m_paused)
+    }
+    else if (snapshot.scene == RenderSnapshot::GAME_OVER)
+    {
+        // Semi-transparent background (overlayed over enemies in background)
+        rectangle(0, 0, W, H, sf::Color(50, 50, 50, 120));
+
+        // Player's previous highest score
+        std::ostringstream scoreTrackSS;
+        if (!snapshot.isNewHighScore)
         {
-            sUserInput();
-            sRender();
+            scoreTrackSS << "High score:" << snapshot.highScore;
         }
-        // In-game scene
         else
         {
+            scoreTrackSS << "Previous High Score:  " << snapshot.highScore - snapshot.diffNewHighScorePrevHighScore << "  (+" << snapshot.diffNewHighScorePrevHighScore << ")";
+        }
+        text(scoreTrackSS.str(), renderer.textBounds(scoreTrackSS.str(), 12), 10, 10, 12, sf::Color::White);
 
-            sEnemySpawner();
-            sMovement();
-            sCollision();
-            sLifespan(); // must be last system call (in order for nuke to work) [What?]
-            sUserInput();
-            sRender();
+        // How to return to start menu instruction
+        const std::string returnToStartMenu = m_netConfig.ENABLED ? "Close the window to quit" : "Press backspace to go to start menu";
+        const sf::FloatRect returnBounds = renderer.textBounds(returnToStartMenu, 12);
+        text(returnToStartMenu, returnBounds, W - returnBounds.width - 10, 10, 12, sf::Color::White);
 
-            m_currentFrame++;
+        // The score they got this game (blinks if it's a new high score), and the line under it
+        std::ostringstream gameScoreSS;
+        sf::Color gameScoreColor(sf::Color::Cyan);
+        if (snapshot.isNewHighScore)
+        {
+            gameScoreSS << "High Score: " << snapshot.gameScore;
+            gameScoreColor.a = 255 * snapshot.blinkAlpha;
+        }
+        else
+        {
+            gameScoreSS << "Score: " << snapshot.gameScore;
         }
+        const sf::FloatRect gameScoreBounds = renderer.textBounds(gameScoreSS.str(), 50);
+        const float gameScoreY = H/2 - gameScoreBounds.height/2;
+        text(gameScoreSS.str(), gameScoreBounds, W/2 - gameScoreBounds.width/2, gameScoreY, 50, gameScoreColor);
+        rectangle(0, gameScoreY + gameScoreBounds.height + 8, W, 1, sf::Color::Cyan);
+
+        // Instructions for how to play again (blinks if they didn't get a new high score)
+        const std::string enterGame = m_netConfig.ENABLED ? "game over" : "press enter to play again";
+        const sf::FloatRect enterGameBounds = renderer.textBounds(enterGame, 16);
+        const sf::Color enterGameColor(255, 255, 255, snapshot.isNewHighScore ? 255 : 255*snapshot.blinkAlpha);
+        text(enterGame, enterGameBounds, W/2 - enterGameBounds.width/2, gameScoreY + gameScoreBounds.height + 30, 16, enterGameColor);
+    }
+    else
+    {
+        std::ostringstream currentScoreSS;
+        currentScoreSS << "Score: " << snapshot.score;
+        renderer.drawText(currentScoreSS.str(), 0, 0, 30, sf::Color::Cyan);
+
+        m_shapeVertices.clear();
+        buildShapeVertices(std::vector<RenderShape>(1, nukeIndicator(snapshot.nukeReady)), m_shapeVertices);
+        renderer.drawTriangles(m_shapeVertices.data(), m_shapeVertices.size());
     }
-    
-    // Close window
-    m_window.close();
 }
 
 /**
- * Initializes the window, loads text font, and spawns the player.
+ * Render thread main loop: passes window events on to the simulation, and draws the newest snapshot.
  */
-void Game::init()
+void Game::renderLoop()
 {
-    const int windowWidth = 1280;
-    const int windowHeight = 720;
-    const int frameLimit = 60;
+    while (m_running)
+    {
+        TimedEvent event;
+        while (m_window.pollEvent(event.event))
+        {
+            if (event.event.type == sf::Event::Closed)
+            {
+                m_running = false;
+            }
 
-    // Initialize the window
-    m_window.create(sf::VideoMode(windowWidth, windowHeight), "GeoWars");
-    m_window.setFramerateLimit(frameLimit);
-    m_window.setKeyRepeatEnabled(false);
+            // The debug overlay works in every scene (the simulation never sees F3)
+            if (event.event.type == sf::Event::KeyPressed && event.event.key.code == sf::Keyboard::F3)
+            {
+                m_debugOverlay = !m_debugOverlay;
+                continue;
+            }
 
-    // Load text font
-    if (!m_font.loadFromFile("/home/rose/Projects/geometry-wars/sofachromergit.otf")) {
-        std::cout << "Error with loading font.\n";
-    }
+            event.time = std::chrono::steady_clock::now();
+            m_events.push(event);
+        }
 
-    spawnPlayer();
+        m_snapshots.update();
+        sRender(m_snapshots.readBuffer());
+        m_renderFrame++;
+    }
 }
 
 /**
- * System for collisions.
+ * Simulation thread main loop: runs the current scene at a fixed tick rate, and publishes a snapshot after every tick.
  */
-void Game::sCollision()
+void Game::simulationLoop()
 {
-    // Bullet-enemy collision
-    for (auto b : m_entities.getEntities("bullet"))
+    const std::chrono::nanoseconds tickDuration(1000000000 / m_windowConfig.TR);
+    std::chrono::steady_clock::time_point nextTick = std::chrono::steady_clock::now();
+
+    m_governor.setBudget(1000.0 / m_windowConfig.TR, 1000.0 / m_windowConfig.FL);
+
+    while (m_running)
     {
-        for (auto e : m_entities.getEntities("enemy"))
+        tick();
+
+        Stopwatch stopwatch;
+        alloc::Counter allocs;
+        publishSnapshot();
+        addSystemCost(FrameGovernor::SNAPSHOT, stopwatch, allocs);
+        m_governor.addCost(FrameGovernor::RENDER, m_renderCost);
+        publishPerf();
+        m_governor.endTick();
+        m_simulatedTicks++;
+
+        // If the simulation fell way behind (e.g. the machine was suspended), don't try to catch up
+        nextTick += tickDuration;
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now - nextTick > tickDuration * 10)
         {
-            if (isOverlap(b->cTransform->pos, e->cTransform->pos, b->cCollision->radius, e->cCollision->radius)) // collision
-            {
-                // Big enemies spawn smaller enemies
-                if (e->cLifespan == nullptr)
-                {
-                    spawnSmallEnemies(e);
-                }
+            nextTick = now;
+        }
+        std::this_thread::sleep_until(nextTick);
+    }
+}
 
-                if (m_player != nullptr)
-                {
-                    // Player scores points for killing enemy
-                    m_player->cScore->score += e->cScore->score;
-                }
+/**
+ * Runs one tick of the current scene.
+ */
+void Game::tick()
+{
+    // Input first (as late as possible before simulating), so what the player did shows up on this tick and not the next one
+    sUserInput();
 
-                b->destroy();
-                e->destroy();
+    // As a last resort when the game is too expensive, enemies spawn less often (not in netplay: both games must spawn the same enemies)
+    const bool throttle = m_governor.level() >= FrameGovernor::THROTTLE_SPAWNER && !m_netConfig.ENABLED;
+    m_spawnThrottle = throttle ? m_governorConfig.SPAWN : 1;
 
-                break;
-            }
-        }
+    // Start menu scene
+    if (m_startMenu)
+    {
+        m_entities.update();
+        sMovement();
+    }
+    // Netplay (in-game and game over scenes)
+    else if (m_netConfig.ENABLED)
+    {
+        netplayTick();
+    }
+    else if (m_endGameMenu)
+    {
+        m_entities.update();
+        updateFlowField();
+        sMovement();
+        sCollision();
+        sLifespan();
+    }
+    // Pause scene
+    else if (m_paused)
+    {
+        m_entities.update();
     }
+    // In-game scene
+    else
+    {
+        PlayerInput inputs[MAX_PLAYERS];
+        inputs[0] = takeLocalInput();
 
-    if (m_player != nullptr)
+        simulate(inputs);
+    }
+}
+
+/**
+ * Publishes what the render thread needs to draw the current scene.
+ */
+void Game::publishSnapshot()
+{
+    RenderSnapshot & snapshot = m_snapshots.writeBuffer();
+
+    snapshot.valid = true;
+    snapshot.scene = m_startMenu ? RenderSnapshot::START_MENU : (m_endGameMenu ? RenderSnapshot::GAME_OVER : RenderSnapshot::IN_GAME);
+    snapshot.paused = m_paused;
+    snapshot.score = currentScore();
+    snapshot.highScore = m_highScore;
+    snapshot.gameScore = m_gameScore;
+    snapshot.isNewHighScore = m_isNewHighScore;
+    snapshot.diffNewHighScorePrevHighScore = m_diffNewHighScorePrevHighScore;
+    snapshot.nukeReady = m_currentFrame - m_lastNukeTime >= m_nukeConfig.CDI;
+
+    // Blinking text (faster when it's a new high score)
+    if (snapshot.scene != RenderSnapshot::IN_GAME)
     {
-        // Player-enemy collision
-        for (auto e : m_entities.getEntities("enemy"))
+        m_startMenuInstructionAlphaPercent -= snapshot.scene == RenderSnapshot::GAME_OVER && m_isNewHighScore ? 0.02 : 0.01;
+        if (m_startMenuInstructionAlphaPercent < 0)
         {
-            if (isOverlap(m_player->cTransform->pos, e->cTransform->pos, m_player->cCollision->radius, e->cCollision->radius)) // collision
-            {
-                m_endGameMenu = true;
+            m_startMenuInstructionAlphaPercent = 1;
+        }
+    }
+    snapshot.blinkAlpha = m_startMenuInstructionAlphaPercent;
+    snapshot.inputTimes.assign(m_simulatedInputTimes.begin(), m_simulatedInputTimes.end());
+    snapshot.qualityLevel = m_governor.level();
+    snapshot.stateLoads = m_stateLoads;
+
+    updateCamera();
+    snapshot.cameraX = m_cameraX;
+    snapshot.cameraY = m_cameraY;
+    const float viewRight = m_cameraX + m_windowConfig.W;
+    const float viewBottom = m_cameraY + m_windowConfig.H;
+
+    // Menus only show enemies (in the background), the game shows everything (player, enemies, bullets, and nukes)
+    const bool inGame = snapshot.scene == RenderSnapshot::IN_GAME;
+    EntityView entities = inGame ? m_entities.view<CTransform, CShape>() : m_entities.view<CTransform, CShape>("enemy");
+
+    // In game, entities don't fade too much (so they don't become invisible yet still alive)
+    const int minAlpha = inGame ? 80 : 0;
+
+    snapshot.shapes.clear();
+    for (auto e : entities)
+    {
+        const sf::CircleShape & circle = e->cShape->circle;
+        RenderShape shape;
+
+        // Only what's in view (the world can be much bigger than the window)
+        shape.x = toFloat(e->cTransform->pos.x);
+        shape.y = toFloat(e->cTransform->pos.y);
+        shape.radius = circle.getRadius();
+        const float extent = shape.radius + std::abs(circle.getOutlineThickness());
+        if (shape.x + extent < m_cameraX || shape.x - extent > viewRight || shape.y + extent < m_cameraY || shape.y - extent > viewBottom)
+        {
+            continue;
+        }
 
-                if (m_player->cScore->score > m_highScore)
-                {
-                    m_diffNewHighScorePrevHighScore = m_player->cScore->score - m_highScore;
-                    m_highScore = m_player->cScore->score;
-                    m_isNewHighScore = true;
-                }
+        shape.angle = e->cTransform->angle;
+        shape.points = circle.getPointCount();
+        shape.outlineThickness = circle.getOutlineThickness();
+        shape.fill = circle.getFillColor();
+        shape.outline = circle.getOutlineColor();
+        shape.id = e->id();
+        shape.version = e->version();
 
-                m_gameScore = m_player->cScore->score;
-                m_player->destroy();
-                m_player = nullptr;
+        if (e->cLifespan != nullptr)
+        {
+            // Entities with lifespans fade as their lifespan shrinks
+            const int MAX_ALPHA = 255;
+            // MAX_ALPHA * (<lifespan percentage>)
+            const int alpha = std::max((int) (MAX_ALPHA * ((float) e->cLifespan->remaining / (float) e->cLifespan->total)), minAlpha);
+            shape.fill.a = alpha;
+            shape.outline.a = alpha;
+        }
 
-                break;
-            }
+        // Under load, enemies and bullets are drawn cheaper (players and nukes always look the same: their outlines matter)
+        const bool cheapShape = e->tag() == "enemy" || e->tag() == "bullet";
+        if (cheapShape && e->cLifespan != nullptr && snapshot.qualityLevel >= FrameGovernor::REDUCED_SHAPES)
+        {
+            // Small (split) enemies and bullets fade away, so fewer corners are hard to notice
+            shape.points = std::max(3, shape.points / 2);
+        }
+        if (cheapShape && snapshot.qualityLevel >= FrameGovernor::NO_OUTLINES)
+        {
+            shape.outlineThickness = 0;
         }
+
+        snapshot.shapes.push_back(shape);
     }
 
-    // Nuke-Enemy collision
-    for (auto n : m_entities.getEntities("nuke"))
+    snapshot.hasDebug = m_debugOverlay;
+    if (snapshot.hasDebug)
     {
-        // Nuke only works during its first frame (not the best way to do this, but it works)
-        if (n->cLifespan->remaining == n->cLifespan->total)
-        {
-            for (auto e : m_entities.getEntities("enemy"))
-            {
-                // Enemy is in explosion if its center is inside the explosion radius
-                bool isInExplosion = isOverlap(e->cTransform->pos, n->cTransform->pos, m_nukeConfig.ER, 0);
-                // Enemy is in blast (shockwave) if its center is inside the blast (shockwave) radius
-                bool isInBlast = isOverlap(e->cTransform->pos, n->cTransform->pos, m_nukeConfig.BR, 0);
+        fillDebugInfo(snapshot.debug);
+    }
 
-                if (isInExplosion || (isInBlast && e->cLifespan != nullptr))
-                {
-                    // Any enemy in the explosion radius dies
-                    // Enemies with 'lifespan' die if they are in blast or explosion radius
+    m_snapshots.publish();
+}
 
-                    if (m_player != nullptr)
-                    {
-                        m_player->cScore->score += e->cScore->score;
-                    }
+/**
+ * Moves the camera to the local player (the window's centre), without showing anything outside the world. It stays
+ * where it is while there's no player.
+ */
+void Game::updateCamera()
+{
+    if (m_player != nullptr)
+    {
+        m_cameraX = toFloat(m_player->cTransform->pos.x) - m_windowConfig.W / 2.0f;
+        m_cameraY = toFloat(m_player->cTransform->pos.y) - m_windowConfig.H / 2.0f;
+    }
 
-                    e->destroy();
-                }
-                else if (isInBlast)
-                {
-                    // A enemy in blast radius is given a 'lifespan' (i.e they will die after a certain amount of time passes),
-                    // their speed is multiplied by the blast speed multiplier (BVM) (i.e their given a speed boost),
-                    // and they are given a higher score value (i.e player gets more for killing these types of enemies)
-
-                    float newSpeed = e->cTransform->velocity.length() * m_nukeConfig.BVM;
-                    Vec2 newVelocity = e->cTransform->pos - n->cTransform->pos;
-                    newVelocity.normalize();
-                    newVelocity *= newSpeed;
-
-                    e->cLifespan = std::make_shared<CLifespan>(m_nukeConfig.REL);
-                    e->cTransform->velocity = newVelocity;
-                    e->cScore->score = m_enemyConfig.SSE;
-                    e->cTransform->angularVel *= -5;
-                }
-            }
+    m_cameraX = std::max(0.0f, std::min(m_cameraX, (float) (m_worldConfig.W - m_windowConfig.W)));
+    m_cameraY = std::max(0.0f, std::min(m_cameraY, (float) (m_worldConfig.H - m_windowConfig.H)));
+}
+
+/**
+ * Fills in what the debug overlay shows about the simulation (the parts in the world only for what's in view).
+ */
+void Game::fillDebugInfo(DebugInfo & debug)
+{
+    for (int system = 0; system < FrameGovernor::SYSTEM_COUNT; system++)
+    {
+        debug.systemMs[system] = (float) m_governor.cost((FrameGovernor::System) system);
+    }
+    debug.pressure = m_governor.pressure();
+
+    debug.entities[PERF_PLAYER] = (int) m_entities.getEntities("player").size();
+    debug.entities[PERF_ENEMY] = (int) m_entities.getEntities("enemy").size();
+    debug.entities[PERF_BULLET] = (int) m_entities.getEntities("bullet").size();
+    debug.entities[PERF_NUKE] = (int) m_entities.getEntities("nuke").size();
+
+    debug.collisionTests = m_collisionTests;
+    debug.collisionHits = (int) m_contacts.size();
+    debug.contactCapacity = (int) m_contacts.capacity();
+    debug.aiThought = m_aiThought;
+    debug.flowFieldBuilds = m_flowField.builds();
+
+    const float viewRight = m_cameraX + m_windowConfig.W;
+    const float viewBottom = m_cameraY + m_windowConfig.H;
+
+    debug.circles.clear();
+    for (auto e : m_entities.view<CTransform, CCollision>())
+    {
+        const float x = toFloat(e->cTransform->pos.x);
+        const float y = toFloat(e->cTransform->pos.y);
+        const float r = toFloat(e->cCollision->radius);
+        if (x + r >= m_cameraX && x - r <= viewRight && y + r >= m_cameraY && y - r <= viewBottom)
+        {
+            debug.circles.push_back(x);
+            debug.circles.push_back(y);
+            debug.circles.push_back(r);
         }
     }
 
-    // Enemy-enemy collision
-    for (auto e1 : m_entities.getEntities("enemy"))
+    // The spawn grid's cells that overlap the view
+    const float cell = (float) std::max(1, m_spawnGrid.cellSize());
+    const int minCol = std::max(0, (int) std::floor((m_cameraX - m_spawnGrid.originX()) / cell));
+    const int minRow = std::max(0, (int) std::floor((m_cameraY - m_spawnGrid.originY()) / cell));
+    const int maxCol = std::min(m_spawnGrid.cols(), (int) std::ceil((viewRight - m_spawnGrid.originX()) / cell));
+    const int maxRow = std::min(m_spawnGrid.rows(), (int) std::ceil((viewBottom - m_spawnGrid.originY()) / cell));
+    debug.gridCols = std::max(0, maxCol - minCol);
+    debug.gridRows = std::max(0, maxRow - minRow);
+    debug.gridCellSize = cell;
+    debug.gridX = m_spawnGrid.originX() + minCol * cell;
+    debug.gridY = m_spawnGrid.originY() + minRow * cell;
+    debug.gridFree.resize(debug.gridCols * debug.gridRows);
+    for (int row = 0; row < debug.gridRows; row++)
     {
-        // Enemies with lifespans can not collide with other enemies (they are ghosts)
-        if (e1->cLifespan != nullptr)
+        for (int col = 0; col < debug.gridCols; col++)
         {
-            continue;
+            debug.gridFree[row * debug.gridCols + col] = m_spawnGrid.isFree((minRow + row) * m_spawnGrid.cols() + minCol + col);
         }
+    }
+}
 
-        for (auto e2 : m_entities.getEntities("enemy"))
+/**
+ * Publishes this tick's performance counters (system costs must be in the governor, before its endTick()).
+ */
+void Game::publishPerf()
+{
+    if (!m_perf.isOpen())
+    {
+        return;
+    }
+
+    PerfFrame & frame = m_perfFrame;
+    frame.tick++;
+    frame.tickMs = 0;
+    for (int system = 0; system < FrameGovernor::SYSTEM_COUNT; system++)
+    {
+        frame.systemMs[system] = (float) m_governor.tickCost((FrameGovernor::System) system);
+        if (system != FrameGovernor::RENDER)
         {
-            // Enemies with lifespans can not collide with other enemies (they are ghosts)
-            if (e1->id() == e2->id() || e2->cLifespan != nullptr)
-            {
-                continue;
-            }
+            frame.tickMs += frame.systemMs[system];
+        }
+    }
+    frame.frameMs = (float) m_renderCost;
+    frame.systemAllocations[FrameGovernor::RENDER] = (std::uint32_t) m_renderAllocations;
+
+    frame.entities[PERF_PLAYER] = (std::uint32_t) m_entities.getEntities("player").size();
+    frame.entities[PERF_ENEMY] = (std::uint32_t) m_entities.getEntities("enemy").size();
+    frame.entities[PERF_BULLET] = (std::uint32_t) m_entities.getEntities("bullet").size();
+    frame.entities[PERF_NUKE] = (std::uint32_t) m_entities.getEntities("nuke").size();
+
+    // Netplay rollback reloads the entity manager, so its totals can go back
+    frame.spawns = m_entities.totalAdded() > m_perfAdded ? (std::uint32_t) (m_entities.totalAdded() - m_perfAdded) : 0;
+    frame.destroys = m_entities.totalRemoved() > m_perfRemoved ? (std::uint32_t) (m_entities.totalRemoved() - m_perfRemoved) : 0;
+    m_perfAdded = m_entities.totalAdded();
+    m_perfRemoved = m_entities.totalRemoved();
+    frame.collisionTests = (std::uint32_t) (m_totalCollisionTests - m_perfCollisionTests);
+    frame.collisionHits = (std::uint32_t) (m_totalCollisionHits - m_perfCollisionHits);
+    m_perfCollisionTests = m_totalCollisionTests;
+    m_perfCollisionHits = m_totalCollisionHits;
+
+    frame.allocations = (std::uint32_t) (alloc::count() - m_perfAllocations);
+    frame.allocatedBytes = alloc::bytes() - m_perfAllocatedBytes;
+    m_perfAllocations = alloc::count();
+    m_perfAllocatedBytes = alloc::bytes();
+
+    m_perf.publish(frame);
+
+    std::fill(frame.systemAllocations, frame.systemAllocations + FrameGovernor::SYSTEM_COUNT, 0);
+}
 
-            if (isOverlap(e1->cTransform->pos, e2->cTransform->pos, e1->cCollision->radius, e2->cCollision->radius)) // collision
-            {
-                // Enemies that collide change direction and go in exact opposite directions of each other, but same speed as each started with
+/**
+ * Initializes the window, and loads text font (the simulation has already spawned the player(s)).
+ */
+void Game::init()
+{
+    // Load text font (it's embedded in the executable). Loading it doesn't need the window, so it's done
+    // on another thread while the window is being created, which is the slow part of starting up.
+    std::future<bool> fontLoaded = std::async(std::launch::async, [this]()
+    {
+        return m_font.loadFromMemory(assets::fontData(), assets::fontSize());
+    });
 
-                Vec2 newDirectionForE1 = e1->cTransform->pos - e2->cTransform->pos;
-                newDirectionForE1.normalize();
+    // Headless mode has no window (the simulation is seeded, so it always plays the same)
+    if (m_renderConfig.HEADLESS)
+    {
+        fontLoaded.get();
+        return;
+    }
 
-                e1->cTransform->velocity = newDirectionForE1 * e1->cTransform->velocity.length();
-                e2->cTransform->velocity = newDirectionForE1 * (e2->cTransform->velocity.length() * -1);
+    // Initialize the window
+    m_window.create(sf::VideoMode(m_windowConfig.W, m_windowConfig.H), "GeoWars");
+    m_window.setVerticalSyncEnabled(m_renderConfig.PACING == FramePacer::VSYNC);
+    m_pacer.setMode(m_renderConfig.PACING, m_windowConfig.FL);
+    m_window.setKeyRepeatEnabled(false);
 
-                // Separate the two so that their is no overlap anymore
-                float halfOverlap = overlap(e1->cTransform->pos, e2->cTransform->pos, e1->cCollision->radius, e2->cCollision->radius)/2; 
-                e1->cTransform->pos += e1->cTransform->velocity * (halfOverlap/e1->cTransform->velocity.length());
-                e2->cTransform->pos += e2->cTransform->velocity * (halfOverlap/e2->cTransform->velocity.length());
-            }
+    // The first frame needs the font
+    if (!fontLoaded.get()) {
+        std::cout << "Error with loading font.\n";
+    }
+
+    if (m_netConfig.ENABLED)
+    {
+        // (the simulation already has both players, and the seed both games share, see simConfigFor())
+        if (!m_net.open(m_netConfig.LOCAL_PORT, m_netConfig.REMOTE_PORT, m_netConfig.DELAY, m_netConfig.LOSS))
+        {
+            std::cout << "Error with opening netplay port " << m_netConfig.LOCAL_PORT << ".\n";
+            m_running = false;
         }
-    }       
+    }
+    else
+    {
+        m_random.setSeed(static_cast<std::uint32_t>(std::time(nullptr)));
+    }
 }
 
 /**
- * System for movement.
+ * Records what a system that just ran cost: its time for the governor, and its allocations.
+ * 
+ * system    - the system
+ * stopwatch - lapped when the system started
+ * allocs    - lapped when the system started
  */
-void Game::sMovement()
+void Game::addSystemCost(FrameGovernor::System system, Stopwatch & stopwatch, alloc::Counter & allocs)
 {
-    // Player movement
-    if (m_player != nullptr)
-    {
-        std::shared_ptr<CInput> playerCI = m_player->cInput;
-        std::shared_ptr<CTransform> playerCT = m_player->cTransform;
-        const float radius = m_player->cShape->circle.getRadius();
-        CInput actualMovementInput;
+    m_governor.addCost(system, stopwatch.lap());
 
-        playerCT->velocity = {0,0}; // zero out player velocity
+    const alloc::Counter::Lap lap = allocs.lap();
+    m_perfFrame.systemAllocations[system] += (std::uint32_t) lap.count;
+    m_systemAllocations[system] += lap.count;
+    m_systemAllocatedBytes[system] += lap.bytes;
+}
 
-        // Things to take into account when determining actual movement input:
-        // 1) Directions that are opposite of each other cancel each other (like up and down)
-        // 2) Player can not move out of bounds, so cancel movement that would move player out of bounds
-        actualMovementInput.up = (playerCI->up && !playerCI->down) && (playerCT->pos.y - radius >= 0);
-        actualMovementInput.down = (playerCI->down && !playerCI->up) && (playerCT->pos.y + radius <= m_window.getSize().y);
-        actualMovementInput.left = (playerCI->left && !playerCI->right) && (playerCT->pos.x - radius >= 0);
-        actualMovementInput.right = (playerCI->right && !playerCI->left) && (playerCT->pos.x + radius <= m_window.getSize().x);
+/**
+ * Runs one frame of netplay (GGPO style rollback).
+ * 
+ * The game never waits for the other player's input: it guesses it (they keep doing what they did last),
+ * and when their actual input arrives and the guess was wrong, it goes back to the saved state of that tick
+ * and simulates the ticks since again. It only waits if it gets more than NET_MAX_ROLLBACK ticks ahead.
+ */
+void Game::netplayTick()
+{
+    const int local = m_netConfig.PLAYER;
+    const int remote = 1 - local;
 
-        if ((actualMovementInput.up || actualMovementInput.down) && (actualMovementInput.left || actualMovementInput.right)) // moving diagonally
-        {
-            // Moving diagonally should have same speed as moving horizontally or vertically
+    // Guess for a tick we don't have the other player's input for yet
+    auto predictRemote = [&]()
+    {
+        PlayerInput prediction = m_netRemoteConfirmed >= 0 ? m_netInputs[remote][m_netRemoteConfirmed % NET_HISTORY] : PlayerInput();
+        prediction.shoot = false;
+        prediction.nuke = false;
+        return prediction;
+    };
 
-            const float componentSpeed = std::sqrt(m_playerConfig.S * 2);
+    // Receive the other player's inputs (in order, any we already have are skipped)
+    int rollbackFrom = m_netTick;
+    InputPacket packet;
+    m_net.update();
+    while (m_net.receive(packet))
+    {
+        m_netRemoteAck = std::max(m_netRemoteAck, (int) packet.ackTick);
 
-            if (actualMovementInput.up) // up
-            {
-                playerCT->velocity.y -= componentSpeed;
-            }
-            else // down
+        for (size_t i = 0; i < packet.inputs.size(); i++)
+        {
+            const int tick = packet.firstTick + i;
+            if (tick != m_netRemoteConfirmed + 1 || tick >= m_netTick + NET_HISTORY / 2)
             {
-                playerCT->velocity.y += componentSpeed;
+                continue;
             }
 
-            if (actualMovementInput.left) // left
-            {
-                playerCT->velocity.x -= componentSpeed;
-            }
-            else // right
+            PlayerInput & stored = m_netInputs[remote][tick % NET_HISTORY];
+            if (tick < m_netTick && stored != packet.inputs[i])
             {
-                playerCT->velocity.x += componentSpeed;
+                // Guessed wrong
+                rollbackFrom = std::min(rollbackFrom, tick);
             }
+            stored = packet.inputs[i];
+            m_netRemoteConfirmed = tick;
         }
-        else // moving horizontally or vertically
+    }
+
+    // Re-simulate from the first wrong guess
+    if (rollbackFrom < m_netTick)
+    {
+        loadState(m_netStates[rollbackFrom % NET_HISTORY]);
+
+        // Effects of these ticks were already shown the first time around
+        m_netResimulating = true;
+
+        for (int tick = rollbackFrom; tick < m_netTick; tick++)
         {
-            if (actualMovementInput.up) // moving up
-            {
-                playerCT->velocity.y -= m_playerConfig.S;
-            }
-            else if (actualMovementInput.down) // moving down
-            {
-                playerCT->velocity.y += m_playerConfig.S;
-            }
-            else if (actualMovementInput.left) // moving left
-            {
-                playerCT->velocity.x -= m_playerConfig.S;
-            }
-            else if (actualMovementInput.right) // moving right
+            if (tick > m_netRemoteConfirmed)
             {
-                playerCT->velocity.x += m_playerConfig.S;
+                m_netInputs[remote][tick % NET_HISTORY] = predictRemote();
             }
+
+            PlayerInput inputs[MAX_PLAYERS];
+            inputs[local] = m_netInputs[local][tick % NET_HISTORY];
+            inputs[remote] = m_netInputs[remote][tick % NET_HISTORY];
+
+            saveState(m_netStates[tick % NET_HISTORY]);
+            simulate(inputs);
         }
 
-        // Move the player
-        playerCT->pos += playerCT->velocity;
+        m_netResimulating = false;
     }
 
-    // Enemy movement
-    for (auto e : m_entities.getEntities("enemy")) 
+    // Simulate the next tick, unless we are too far ahead of the other player
+    if (m_netTick - m_netRemoteConfirmed <= NET_MAX_ROLLBACK)
     {
-        // Enemies travel in straight directions, and bounce of the walls and other enemies
-
-        const float radius = e->cShape->circle.getRadius();
-        Vec2& pos = e->cTransform->pos;
-        Vec2& vel = e->cTransform->velocity;
-
-        // Enemies bounce off the walls (they shouldn't go outside window)
-        if (pos.x - radius <= 0 || pos.x + radius >= m_window.getSize().x)
+        const int tick = m_netTick;
+        m_netInputs[local][tick % NET_HISTORY] = takeLocalInput();
+        if (tick > m_netRemoteConfirmed)
         {
-            vel.x *= -1;
-            e->cTransform->angularVel *= -1;
-        }
-        if (pos.y - radius <= 0 || pos.y + radius >= m_window.getSize().y)
-        {
-            vel.y *= -1;
-            e->cTransform->angularVel *= -1;
+            m_netInputs[remote][tick % NET_HISTORY] = predictRemote();
         }
 
-        // Move the enemy
-        pos += vel;
+        PlayerInput inputs[MAX_PLAYERS];
+        inputs[local] = m_netInputs[local][tick % NET_HISTORY];
+        inputs[remote] = m_netInputs[remote][tick % NET_HISTORY];
+
+        saveState(m_netStates[tick % NET_HISTORY]);
+        simulate(inputs);
+        m_netTick++;
+    }
+
+    // Send the inputs the other player doesn't have yet
+    InputPacket outgoing;
+    outgoing.firstTick = std::max(m_netRemoteAck + 1, m_netTick - NET_MAX_RESEND);
+    outgoing.ackTick = m_netRemoteConfirmed;
+    for (int tick = outgoing.firstTick; tick < m_netTick; tick++)
+    {
+        outgoing.inputs.push_back(m_netInputs[local][tick % NET_HISTORY]);
     }
+    m_net.send(outgoing);
+}
 
-    // Bullet movement
-    for (auto b : m_entities.getEntities("bullet")) 
+/**
+ * Returns the input of the local player for the next tick.
+ * 
+ * One-off actions (shoot, nuke) are cleared, so they only happen once.
+ */
+PlayerInput Game::takeLocalInput()
+{
+    PlayerInput input = m_localInput;
+    m_localInput.shoot = false;
+    m_localInput.nuke = false;
+
+    // The input events are simulated now
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    for (const std::chrono::steady_clock::time_point & time : m_localInputTimes)
     {
-        // Bullets travel in straight directions (they don't bounce of walls. they can go outside the window)
+        m_inputSimulatedLatency.add(std::chrono::duration<double, std::milli>(now - time).count());
 
-        // Move the bullet
-        b->cTransform->pos += b->cTransform->velocity;
+        // Kept for a few ticks, so they still reach the render thread if it skips some snapshots
+        m_simulatedInputTimes.push_back(time);
+        if (m_simulatedInputTimes.size() > MAX_TRACKED_INPUTS)
+        {
+            m_simulatedInputTimes.pop_front();
+        }
     }
+    m_localInputTimes.clear();
+
+    return input;
 }
 
 /**
@@ -384,13 +888,19 @@ void Game::sMovement()
  */
 void Game::sUserInput()
 {
-    sf::Event event;
-    while (m_window.pollEvent(event))
+    // Window events are handed over by the render thread
+    TimedEvent timedEvent;
+    while (m_events.pop(timedEvent))
     {
-        if (event.type == sf::Event::Closed)
+        const sf::Event & event = timedEvent.event;
+
+        // Movement keys are tracked in game and while paused (so a key let go of while paused doesn't stay held)
+        if (!m_startMenu && !m_endGameMenu && (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased))
         {
-            m_running = false;
-            break;
+            if (setMovementKey(event.key.code, event.type == sf::Event::KeyPressed) && !m_paused)
+            {
+                m_localInputTimes.push_back(timedEvent.time);
+            }
         }
 
         if (m_startMenu) // Start menu
@@ -402,7 +912,11 @@ void Game::sUserInput()
         }
         else if (m_endGameMenu) // Game over menu
         {
-            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Enter)
+            if (m_netConfig.ENABLED)
+            {
+                // Netplay is one game only (close the window to quit)
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Enter)
             {
                 m_endGameMenu = false;
 
@@ -410,7 +924,7 @@ void Game::sUserInput()
 
                 for (auto e : m_entities.getEntities("enemy"))
                 {
-                    e->destroy();
+                    destroyEnemy(e);
                 }
 
                 m_entities.update();
@@ -430,7 +944,7 @@ void Game::sUserInput()
 
                 for (auto e : m_entities.getEntities("enemy"))
                 {
-                    e->destroy();
+                    destroyEnemy(e);
                 }
 
                 spawnEnemy();
@@ -443,101 +957,28 @@ void Game::sUserInput()
             {
                 m_paused = false;
             }
-            else if (event.type == sf::Event::KeyPressed)
-            {
-                if (event.key.code == sf::Keyboard::W)
-                {
-                    m_player->cInput->up = true;
-                }
-                else if (event.key.code == sf::Keyboard::A)
-                {
-                    m_player->cInput->left = true;
-                }
-                else if (event.key.code == sf::Keyboard::S)
-                {
-                    m_player->cInput->down = true;
-                }
-                else if (event.key.code == sf::Keyboard::D)
-                {
-                    m_player->cInput->right = true;
-                }
-            }
-            else if (event.type == sf::Event::KeyReleased)
-            {
-                if (event.key.code == sf::Keyboard::W)
-                {
-                    m_player->cInput->up = false;
-                }
-                else if (event.key.code == sf::Keyboard::A)
-                {
-                    m_player->cInput->left = false;
-                }
-                else if (event.key.code == sf::Keyboard::S)
-                {
-                    m_player->cInput->down = false;
-                }
-                else if (event.key.code == sf::Keyboard::D)
-                {
-                    m_player->cInput->right = false;
-                }
-            }
         }
         else // In game 
         {
-            if (event.type == sf::Event::KeyPressed)
-            {
-                if (event.key.code == sf::Keyboard::P)
-                {
-                    m_paused = true;
-                }
-                else if (event.key.code == sf::Keyboard::W)
-                {
-                    m_player->cInput->up = true;
-                }
-                else if (event.key.code == sf::Keyboard::A)
-                {
-                    m_player->cInput->left = true;
-                }
-                else if (event.key.code == sf::Keyboard::S)
-                {
-                    m_player->cInput->down = true;
-                }
-                else if (event.key.code == sf::Keyboard::D)
-                {
-                    m_player->cInput->right = true;
-                }
-            }
-            else if (event.type == sf::Event::KeyReleased)
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::P && !m_netConfig.ENABLED) // can't pause netplay
             {
-                if (event.key.code == sf::Keyboard::W)
-                {
-                    m_player->cInput->up = false;
-                }
-                else if (event.key.code == sf::Keyboard::A)
-                {
-                    m_player->cInput->left = false;
-                }
-                else if (event.key.code == sf::Keyboard::S)
-                {
-                    m_player->cInput->down = false;
-                }
-                else if (event.key.code == sf::Keyboard::D)
-                {
-                    m_player->cInput->right = false;
-                }
+                m_paused = true;
             }
             else if (event.type == sf::Event::MouseButtonPressed) 
             {
+                // Weapons are fired by the simulation when it takes the input (see sPlayerInput())
                 if (event.mouseButton.button == sf::Mouse::Left)
                 {
-                    spawnBullet(m_player, Vec2(event.mouseButton.x, event.mouseButton.y));
+                    m_localInput.shoot = true;
+                    // (the click is on the window, aiming is in the world)
+                    m_localInput.aimX = event.mouseButton.x + m_cameraX;
+                    m_localInput.aimY = event.mouseButton.y + m_cameraY;
+                    m_localInputTimes.push_back(timedEvent.time);
                 }
                 if (event.mouseButton.button == sf::Mouse::Right)
                 {
-                    if (m_currentFrame - m_lastNukeTime >= m_nukeConfig.CDI) {
-                        spawnSpecialWeapon(m_player);
-                        m_lastNukeTime = m_currentFrame;
-                    }
+                    m_localInput.nuke = true;
+                    m_localInputTimes.push_back(timedEvent.time);
                 }
             }
         }
@@ -545,71 +986,66 @@ void Game::sUserInput()
 }
 
 /**
- * System for lifespan.
+ * Sets whether a movement key (WASD) is held.
+ * 
+ * Returns false if the key is not a movement key.
+ * 
+ * key     - the key
+ * pressed - true if it was pressed, false if it was let go of
  */
-void Game::sLifespan()
+bool Game::setMovementKey(sf::Keyboard::Key key, bool pressed)
 {
-    // Entities with lifespans will die once their lifespan is over.
-
-    for (auto e : m_entities.getEntities())
+    switch (key)
     {
-        if (e->cLifespan != nullptr)
-        {
-            if (e->cLifespan->remaining > 0) 
-            {
-                e->cLifespan->remaining--;
-            } else 
-            {
-                e->destroy();
-            }
-        }
+        case sf::Keyboard::W: m_localInput.up = pressed; return true;
+        case sf::Keyboard::A: m_localInput.left = pressed; return true;
+        case sf::Keyboard::S: m_localInput.down = pressed; return true;
+        case sf::Keyboard::D: m_localInput.right = pressed; return true;
+        default: return false;
     }
 }
 
 /**
- * System for rendering.
+ * System for rendering (runs on the render thread).
+ * 
+ * snapshot - what to draw
  */
-void Game::sRender()
+void Game::sRender(const RenderSnapshot & snapshot)
 {
+    Stopwatch stopwatch;
+    alloc::Counter allocs;
+
     m_window.clear(); // clear the window
     const sf::Vector2u WINDOW_SIZE = m_window.getSize();
 
-    // 3 Scenes: start menu, in-game, and game-over
-    // Only one scene will be rendered
+    // Frame times for the debug overlay's graph (kept even while it's off, so it has a history when turned on)
+    const std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+    m_debugFrameTimes[m_debugFrameIndex] = std::chrono::duration<float, std::milli>(frameStart - m_debugLastFrame).count();
+    m_debugFrameIndex = (m_debugFrameIndex + 1) % DEBUG_FRAME_HISTORY;
+    m_debugLastFrame = frameStart;
 
-    // Render start menu scene
-    if (m_startMenu)
+    // Nothing to draw until the simulation has run once
+    if (!snapshot.valid)
     {
-        for (auto e : m_entities.getEntities("enemy")) // Draw enemies
-        {
-            std::shared_ptr<CTransform> transform = e->cTransform;
-            std::shared_ptr<CShape> shape = e->cShape;
-            std::shared_ptr<CLifespan> lifespan = e->cLifespan;
-
-            transform->angle += transform->angularVel;
-            shape->circle.setPosition(transform->pos.x, transform->pos.y);
-            shape->circle.setRotation(transform->angle);
-
-            if (lifespan != nullptr)
-            {
-                // Enemies with lifespans fade as their lifespan shrinks
-
-                const int MAX_ALPHA = 255;
-                sf::Color updatedFill = shape->circle.getFillColor();
-                sf::Color updatedOutline = shape->circle.getOutlineColor();
-
-                // MAX_ALPHA * (<lifespan percentage>)
-                const int alpha = MAX_ALPHA * ((float) lifespan->remaining / (float) lifespan->total);
+        m_pacer.wait();
+        m_window.display();
+        m_pacer.presented();
+        return;
+    }
 
-                updatedFill.a = alpha;
-                updatedOutline.a = alpha;
+    // Particles move once per frame (not per simulation tick: they are only for looks)
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    updateParticles(snapshot, std::min(0.1f, std::chrono::duration<float>(now - m_lastParticleUpdate).count()));
+    playSounds(std::chrono::duration<float>(now - m_lastParticleUpdate).count());
+    m_lastParticleUpdate = now;
 
-                shape->circle.setFillColor(updatedFill);
-                shape->circle.setOutlineColor(updatedOutline);
-            }
+    // 3 Scenes: start menu, in-game, and game-over
+    // Only one scene will be rendered
 
-            m_window.draw(shape->circle);
-        }
+    // Render start menu scene
+    if (snapshot.scene == RenderSnapshot::START_MENU)
+    {
+        drawWorld(snapshot); // Draw enemies
 
         // Semi-transparent background (overlayed over enemies in background)
         const sf::Color overlayBackground(50, 50, 50, 120);
@@ -643,12 +1079,7 @@ void Game::sRender()
         enterGame.setString("press enter to play");
         enterGame.setCharacterSize(16);
         // Make it blink
-        enterGame.setColor(sf::Color(255, 255, 255, 255*m_startMenuInstructionAlphaPercent));
-        m_startMenuInstructionAlphaPercent -= 0.01;
-        if (m_startMenuInstructionAlphaPercent < 0)
-        {
-            m_startMenuInstructionAlphaPercent = 1;
-        }
+        enterGame.setColor(sf::Color(255, 255, 255, 255*snapshot.blinkAlpha));
         enterGame.setOrigin(sf::Vector2f(enterGame.getLocalBounds().left, enterGame.getLocalBounds().top));
         enterGame.setPosition(sf::Vector2f(WINDOW_SIZE.x/2 - enterGame.getLocalBounds().width/2, title.getPosition().y + title.getLocalBounds().height + margin));
         m_window.draw(enterGame);
@@ -719,38 +1150,9 @@ void Game::sRender()
         m_window.draw(specialWeapon);
         m_window.draw(pause);
     }
-    else if (m_endGameMenu) // End game (game over) scene
+    else if (snapshot.scene == RenderSnapshot::GAME_OVER) // End game (game over) scene
     {
-        for (auto e : m_entities.getEntities("enemy")) // Draw enemies
-        {
-            std::shared_ptr<CTransform> transform = e->cTransform;
-            std::shared_ptr<CShape> shape = e->cShape;
-            std::shared_ptr<CLifespan> lifespan = e->cLifespan;
-
-            transform->angle += transform->angularVel;
-            shape->circle.setPosition(transform->pos.x, transform->pos.y);
-            shape->circle.setRotation(transform->angle);
-
-            if (lifespan != nullptr)
-            {
-                // Enemies with lifespans fade as their lifespan shrinks
-
-                const int MAX_ALPHA = 255;
-                sf::Color updatedFill = shape->circle.getFillColor();
-                sf::Color updatedOutline = shape->circle.getOutlineColor();
-
-                // MAX_ALPHA * (<lifespan percentage>)
-                const int alpha = MAX_ALPHA * ((float) lifespan->remaining / (float) lifespan->total);
-
-                updatedFill.a = alpha;
-                updatedOutline.a = alpha;
-
-                shape->circle.setFillColor(updatedFill);
-                shape->circle.setOutlineColor(updatedOutline);
-            }
-
-            m_window.draw(shape->circle);
-        }
+        drawWorld(snapshot); // Draw enemies (and effects)
 
         // Semi-transparent background (overlayed over enemies in background)
         const sf::Color overlayBackground(50, 50, 50, 120);
@@ -761,15 +1163,15 @@ void Game::sRender()
 
         // Show player previous highest score
         std::ostringstream scoreTrackSS;
-        if (!m_isNewHighScore)
+        if (!snapshot.isNewHighScore)
         {
             // They did not beat it this game
-            scoreTrackSS << "High score:" << m_highScore;
+            scoreTrackSS << "High score:" << snapshot.highScore;
         }
         else
         {
             // They beat it, so its now the previous highest score
-            scoreTrackSS << "Previous High Score:  " << m_highScore - m_diffNewHighScorePrevHighScore << "  (+" << m_diffNewHighScorePrevHighScore << ")"; 
+            scoreTrackSS << "Previous High Score:  " << snapshot.highScore - snapshot.diffNewHighScorePrevHighScore << "  (+" << snapshot.diffNewHighScorePrevHighScore << ")"; 
         }
         sf::Text scoreTracker;
         scoreTracker.setColor(sf::Color::White);
@@ -783,7 +1185,8 @@ void Game::sRender()
         // How to return to start menu instruction
         sf::Text returnToStartMenu;
         returnToStartMenu.setColor(sf::Color::White);
-        returnToStartMenu.setString("Press backspace to go to start menu");
+        // (netplay is one game only)
+        returnToStartMenu.setString(m_netConfig.ENABLED ? "Close the window to quit" : "Press backspace to go to start menu");
         returnToStartMenu.setFont(m_font);
         returnToStartMenu.setCharacterSize(12);
         returnToStartMenu.setOrigin(sf::Vector2f(returnToStartMenu.getLocalBounds().left, returnToStartMenu.getLocalBounds().top));
@@ -793,25 +1196,20 @@ void Game::sRender()
         // Show the player the score they got this game
         std::ostringstream gameScoreSS;
         sf::Text gameScore;
-        if (m_isNewHighScore)
+        if (snapshot.isNewHighScore)
         {
             // They got new high score, so make it blink
 
             sf::Color cyan(sf::Color::Cyan);
-            cyan.a = 255 * m_startMenuInstructionAlphaPercent;
-            m_startMenuInstructionAlphaPercent -= 0.02;
-            if (m_startMenuInstructionAlphaPercent < 0)
-            {
-                m_startMenuInstructionAlphaPercent = 1;
-            }
-            gameScoreSS << "High Score: " << m_gameScore;
+            cyan.a = 255 * snapshot.blinkAlpha;
+            gameScoreSS << "High Score: " << snapshot.gameScore;
             gameScore.setColor(cyan);
         }
         else
         {
             // They did not get a new high score
 
-            gameScoreSS << "Score: " << m_gameScore;
+            gameScoreSS << "Score: " << snapshot.gameScore;
             gameScore.setColor(sf::Color::Cyan);
         }
         gameScore.setString(gameScoreSS.str());
@@ -833,9 +1231,9 @@ void Game::sRender()
         float margin = 30;
         sf::Text enterGame;
         enterGame.setFont(m_font);
-        enterGame.setString("press enter to play again");
+        enterGame.setString(m_netConfig.ENABLED ? "game over" : "press enter to play again");
         enterGame.setCharacterSize(16);
-        if (m_isNewHighScore)
+        if (snapshot.isNewHighScore)
         {
             enterGame.setColor(sf::Color(255, 255, 255, 255));
         }
@@ -843,12 +1241,7 @@ void Game::sRender()
         {
             // Blinks if player did not get a high score
         
-            enterGame.setColor(sf::Color(255, 255, 255, 255*m_startMenuInstructionAlphaPercent));
-            m_startMenuInstructionAlphaPercent -= 0.01;
-            if (m_startMenuInstructionAlphaPercent < 0)
-            {
-                m_startMenuInstructionAlphaPercent = 1;
-            }
+            enterGame.setColor(sf::Color(255, 255, 255, 255*snapshot.blinkAlpha));
         }
         enterGame.setOrigin(sf::Vector2f(enterGame.getLocalBounds().left, enterGame.getLocalBounds().top));
         enterGame.setPosition(sf::Vector2f(WINDOW_SIZE.x/2 - enterGame.getLocalBounds().width/2, gameScore.getPosition().y + gameScore.getLocalBounds().height + margin));
@@ -856,41 +1249,19 @@ void Game::sRender()
     }
     else // in game
     {
-        // Draw all entities (player, enemies, bullets, and nukes)
-        for (auto e : m_entities.getEntities())
-        {
-            std::shared_ptr<CTransform> transform = e->cTransform;
-            std::shared_ptr<CShape> shape = e->cShape;
-            std::shared_ptr<CLifespan> lifespan = e->cLifespan;
-
-            transform->angle += transform->angularVel;
-            shape->circle.setPosition(transform->pos.x, transform->pos.y);
-            shape->circle.setRotation(transform->angle);
-
-            if (lifespan != nullptr)
-            {
-                // Entities (enemies, bullets, and nukes) with lifespans fade as their lifespan shrinks
-
-                const int MAX_ALPHA = 255;
-                sf::Color updatedFill = shape->circle.getFillColor();
-                sf::Color updatedOutline = shape->circle.getOutlineColor();
-
-                // Prevents enemies from fading too much and becoming invisible yet still alive
-                const int alpha = MAX_ALPHA * ((float) lifespan->remaining / (float) lifespan->total) > 80 ? MAX_ALPHA * ((float) lifespan->remaining / (float) lifespan->total) : 80;
-
-                updatedFill.a = alpha;
-                updatedOutline.a = alpha;
-
-                shape->circle.setFillColor(updatedFill);
-                shape->circle.setOutlineColor(updatedOutline);
-            }
+        // Draw all entities (player, enemies, bullets, and nukes), and effects on top
+        drawWorld(snapshot);
 
-            m_window.draw(shape->circle);
+        // Under load, the HUD (score and nuke cool down) is only updated every few frames
+        if (snapshot.qualityLevel < FrameGovernor::SLOW_HUD || m_renderFrame % m_governorConfig.HUD == 0)
+        {
+            m_hudScore = snapshot.score;
+            m_hudNukeReady = snapshot.nukeReady;
         }
 
         // Show the player's current score
         std::ostringstream currentScoreSS;
-        currentScoreSS << "Score: " << m_player->cScore->score;
+        currentScoreSS << "Score: " << m_hudScore;
         sf::Text score;
         score.setFont(m_font);
         score.setString(currentScoreSS.str());
@@ -898,21 +1269,9 @@ void Game::sRender()
         score.setColor(sf::Color::Cyan);
         m_window.draw(score);
 
-        // The special weapon (nuke) cool down indicator (faded when its not available, its a miniature version of actual nuke)
-        sf::CircleShape nukeCoolDownIndicator;
-        int alpha = m_currentFrame - m_lastNukeTime >= m_nukeConfig.CDI ? 255 : 255 * 0.40;
-        sf::Color fill = sf::Color(m_nukeConfig.FR, m_nukeConfig.FG, m_nukeConfig.FB, alpha);
-        sf::Color outline = sf::Color(m_nukeConfig.OR, m_nukeConfig.OG, m_nukeConfig.OB, alpha);
-        // Miniature version w/ same proportions
-        float explosionRadius = 10;
-        float blastRadius = explosionRadius * m_nukeConfig.BR / m_nukeConfig.ER;
-        nukeCoolDownIndicator.setFillColor(fill);
-        nukeCoolDownIndicator.setOutlineColor(outline);
-        nukeCoolDownIndicator.setRadius(explosionRadius);
-        nukeCoolDownIndicator.setOutlineThickness(blastRadius - explosionRadius);
-        nukeCoolDownIndicator.setPointCount(m_nukeConfig.V);
-        nukeCoolDownIndicator.setPosition(15,50);
-        m_window.draw(nukeCoolDownIndicator);
+        // The special weapon (nuke) cool down indicator
+        m_hudShapes.assign(1, nukeIndicator(m_hudNukeReady));
+        drawShapes(m_hudShapes);
 
         // no spawn zone around player (for debugging)
         // draw a circle with radius of no spawn zone on player
@@ -924,7 +1283,7 @@ void Game::sRender()
         // noSpawnZone.setPosition(sf::Vector2f(m_player->cTransform->pos.x, m_player->cTransform->pos.y));
         // m_window.draw(noSpawnZone);
 
-        if (m_paused) // paused (just renders an overlay over the in-game scene)
+        if (snapshot.paused) // paused (just renders an overlay over the in-game scene)
         {
             // Draw overlay, and pause symbol
 
@@ -960,157 +1319,540 @@ void Game::sRender()
         }
     }
 
+    // What drawing cost (waiting for the next frame is left out)
+    m_renderCost = stopwatch.lap();
+
+    const alloc::Counter::Lap lap = allocs.lap();
+    m_renderAllocations = lap.count;
+    m_systemAllocations[FrameGovernor::RENDER] += lap.count;
+    m_systemAllocatedBytes[FrameGovernor::RENDER] += lap.bytes;
+
+    // On top of everything, and left out of the render cost (the governor shouldn't lower quality for it)
+    if (snapshot.hasDebug && m_debugOverlay)
+    {
+        drawDebugOverlay(snapshot);
+    }
+
+    m_pacer.wait();
     m_window.display();
+    m_pacer.presented();
+
+    // Input latency: the first time a frame with an input event's effect is presented
+    for (const std::chrono::steady_clock::time_point & time : snapshot.inputTimes)
+    {
+        if (time > m_lastPresentedInputTime)
+        {
+            m_inputPresentedLatency.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - time).count());
+            m_lastPresentedInputTime = time;
+        }
+    }
+
+    // Report how long it took for the first frame with something in it to show
+    if (!m_firstFrameShown)
+    {
+        m_firstFrameShown = true;
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+        std::cout << "Time to first frame: " << ms << " ms\n";
+    }
 }
 
 /**
- * System for spawning enemies.
+ * Draws the snapshot's part of the world (entities, and effects outside the start menu) through the camera. The
+ * window's default view is back on afterwards, for the HUD and menus.
+ * 
+ * snapshot - what to draw
  */
-void Game::sEnemySpawner()
+void Game::drawWorld(const RenderSnapshot & snapshot)
 {
-    // 1 enemy is spawned after one 'spawn interval' has passed
-    
-    if (m_currentFrame - m_lastEnemySpawnTime >= m_enemyConfig.SI) {
-        spawnEnemy();
-        m_lastEnemySpawnTime = m_currentFrame;
-    };
+    const sf::Vector2u WINDOW_SIZE = m_window.getSize();
+    m_window.setView(sf::View(sf::FloatRect(snapshot.cameraX, snapshot.cameraY, WINDOW_SIZE.x, WINDOW_SIZE.y)));
+
+    const std::vector<sf::Vertex> & vertices = buildEntityVertices(snapshot);
+    if (!vertices.empty())
+    {
+        m_window.draw(vertices.data(), vertices.size(), sf::Triangles);
+    }
+    if (snapshot.scene != RenderSnapshot::START_MENU)
+    {
+        drawParticles();
+    }
+
+    m_window.setView(m_window.getDefaultView());
 }
 
 /**
- * Spawns the player.
+ * Draws shapes (all of them in one draw call).
+ * 
+ * shapes - shapes to draw, in order
  */
-void Game::spawnPlayer()
+void Game::drawShapes(const std::vector<RenderShape> & shapes)
 {
-    auto entity = m_entities.addEntity("player");
+    m_shapeVertices.clear();
+    buildShapeVertices(shapes, m_shapeVertices);
 
-    entity->cTransform = std::make_shared<CTransform>(Vec2(m_window.getSize().x / 2.0f, m_window.getSize().y / 2.0f), Vec2(3.0f,3.0f), 0.0f);
-    entity->cShape = std::make_shared<CShape>(32.0f, 8, sf::Color(10,10,10), sf::Color(255,0,0), 4.0f);
-    entity->cInput = std::make_shared<CInput>();
-    entity->cCollision = std::make_shared<CCollision>(m_playerConfig.CR);
-    entity->cScore = std::make_shared<CScore>(0);
-
-    m_player = entity;
-    m_isNewHighScore = false;
+    if (!m_shapeVertices.empty())
+    {
+        m_window.draw(m_shapeVertices.data(), m_shapeVertices.size(), sf::Triangles);
+    }
 }
 
 /**
- * Spawns 'small' enemies.
+ * Turns shapes into triangles (for sf::Triangles).
+ * 
+ * Builds the same triangles SFML would build for each sf::CircleShape (fill, then outline), but with rotations
+ * computed for all shapes in one batch.
+ * 
+ * shapes   - shapes, in drawing order
+ * vertices - where to add the triangles
  */
-void Game::spawnSmallEnemies(std:: shared_ptr<Entity> bigEnemy)
+void Game::buildShapeVertices(const std::vector<RenderShape> & shapes, std::vector<sf::Vertex> & vertices)
 {
-    // When a big enemy is killed, it will break up into smaller enemies
+    m_renderAngles.resize(shapes.size());
+    m_renderSines.resize(shapes.size());
+    m_renderCosines.resize(shapes.size());
+
+    for (size_t i = 0; i < shapes.size(); i++)
+    {
+        m_renderAngles[i] = shapes[i].angle;
+    }
 
-    // The number of small enemies to spawn is equal to the number of vertices the big enemy has
-    const int numberOfSmallEnemies = bigEnemy->cShape->circle.getPointCount();
-    const float speed = bigEnemy->cTransform->velocity.length();
+    fastmath::sincosDeg(m_renderAngles.data(), m_renderSines.data(), m_renderCosines.data(), shapes.size());
 
-    for (int i = 0; i < numberOfSmallEnemies; i++) 
+    for (size_t i = 0; i < shapes.size(); i++)
     {
-        // Each small enemy goes off in the direction of a vertex (starting from the center of big enemy)
+        appendShapeVertices(shapes[i], m_renderCosines[i], m_renderSines[i], vertices);
+    }
+}
+
+/**
+ * Turns the snapshot's shapes into triangles, like buildShapeVertices(), reusing the unrotated triangles of entities
+ * that haven't changed since the last frame drawn. An entity's version only changes when a system changes how it
+ * looks apart from where it is and which way it's turned (see Entity::version()), so only new, fading and resized
+ * entities are made again: the rest only have their cached triangles turned and moved into place.
+ * 
+ * Returns the triangles (valid until the next call).
+ * 
+ * snapshot - what to draw
+ */
+const std::vector<sf::Vertex> & Game::buildEntityVertices(const RenderSnapshot & snapshot)
+{
+    const std::vector<RenderShape> & shapes = snapshot.shapes;
 
-        const float angle = 360/numberOfSmallEnemies * (i) + bigEnemy->cTransform->angle;
-        Vec2 vel;
-        Vec2 pos;
-        vel.polar(angle, speed);
+    // Versions from before a rollback can't be compared with those after, and the quality level and scene change how
+    // shapes are made from their entities
+    if (snapshot.stateLoads != m_cachedStateLoads || snapshot.qualityLevel != m_cachedQualityLevel || snapshot.scene != m_cachedScene)
+    {
+        m_cachedShapes.clear();
+        m_cachedStateLoads = snapshot.stateLoads;
+        m_cachedQualityLevel = snapshot.qualityLevel;
+        m_cachedScene = snapshot.scene;
+    }
+
+    // Rotations first, in one batch
+    m_renderAngles.resize(shapes.size());
+    m_renderSines.resize(shapes.size());
+    m_renderCosines.resize(shapes.size());
+    for (size_t i = 0; i < shapes.size(); i++)
+    {
+        m_renderAngles[i] = shapes[i].angle;
+    }
+    fastmath::sincosDeg(m_renderAngles.data(), m_renderSines.data(), m_renderCosines.data(), shapes.size());
+
+    // Entities still at the version they were last frame keep their triangles (both lists are in entity order, so
+    // it's one pass)
+    m_nextCachedShapes.clear();
+    m_nextLocalVertices.clear();
+    m_entityVertices.clear();
+    int rebuilt = 0;
+    size_t cached = 0;
+    for (size_t i = 0; i < shapes.size(); i++)
+    {
+        const RenderShape & shape = shapes[i];
+        while (cached < m_cachedShapes.size() && m_cachedShapes[cached].id < shape.id)
+        {
+            cached++;
+        }
 
-        auto smallEnemy = m_entities.addEntity("enemy");
+        CachedShape next = { shape.id, shape.version, (std::uint32_t) m_nextLocalVertices.size(), 0 };
+        if (cached < m_cachedShapes.size() && m_cachedShapes[cached].id == shape.id && m_cachedShapes[cached].version == shape.version)
+        {
+            const std::vector<ShapeVertex>::const_iterator from = m_localVertices.begin() + m_cachedShapes[cached].first;
+            m_nextLocalVertices.insert(m_nextLocalVertices.end(), from, from + m_cachedShapes[cached].count);
+        }
+        else
+        {
+            appendLocalVertices(shape, m_nextLocalVertices);
+            rebuilt++;
+        }
+        next.count = (std::uint32_t) (m_nextLocalVertices.size() - next.first);
+        m_nextCachedShapes.push_back(next);
 
-        // These smaller enemies spawn where the big enemy died, they are worth double
-        // the points of the big enemy, and have a lifespan
-        smallEnemy->cTransform = std::make_shared<CTransform>(bigEnemy->cTransform->pos, vel, 0);
-        smallEnemy->cCollision = std::make_shared<CCollision>(bigEnemy->cCollision->radius/2);
-        smallEnemy->cShape = std::make_shared<CShape>(bigEnemy->cShape->circle.getRadius()/2, bigEnemy->cShape->circle.getPointCount(), bigEnemy->cShape->circle.getFillColor(), bigEnemy->cShape->circle.getOutlineColor(), bigEnemy->cShape->circle.getOutlineThickness()/2);
-        smallEnemy->cLifespan = std::make_shared<CLifespan>(m_enemyConfig.L);
-        smallEnemy->cScore = std::make_shared<CScore>(m_enemyConfig.SSE);
+        placeVertices(m_nextLocalVertices.data() + next.first, next.count, shape, m_renderCosines[i], m_renderSines[i], m_entityVertices);
     }
+
+    std::swap(m_cachedShapes, m_nextCachedShapes);
+    std::swap(m_localVertices, m_nextLocalVertices);
+    m_shapesDrawn = (int) shapes.size();
+    m_shapesRebuilt = rebuilt;
+    return m_entityVertices;
+}
+
+/**
+ * Adds one shape's triangles (see buildShapeVertices()).
+ * 
+ * shape    - the shape
+ * c        - cosine of its angle
+ * s        - sine of its angle
+ * vertices - where to add the triangles
+ */
+void Game::appendShapeVertices(const RenderShape & shape, float c, float s, std::vector<sf::Vertex> & vertices)
+{
+    m_shapeScratch.clear();
+    appendLocalVertices(shape, m_shapeScratch);
+    placeVertices(m_shapeScratch.data(), m_shapeScratch.size(), shape, c, s, vertices);
 }
 
 /**
- * Spawns a bullet.
+ * Adds one shape's triangles around its center, unrotated (placeVertices() turns them and moves them into place).
+ * 
+ * shape    - the shape (its position and angle aren't used)
+ * vertices - where to add the triangles
  */
-void Game::spawnBullet(std::shared_ptr<Entity> player, const Vec2 & mousePos)
+void Game::appendLocalVertices(const RenderShape & shape, std::vector<ShapeVertex> & vertices)
 {
-    // Bullet starts off at center of player
-    // It goes towards the direction of the mouse
+    const std::vector<sf::Vector2f> & unit = unitPolygon(shape.points);
+
+    // Outline is pushed out along the corner's bisector, like SFML does (so its edges are thickness away from the fill's)
+    const float outerRadius = shape.radius + shape.outlineThickness / unit.back().x;
+
+    for (int k = 0; k < shape.points; k++)
+    {
+        // Corners k and k+1
+        const sf::Vector2f & u0 = unit[k];
+        const sf::Vector2f & u1 = unit[(k + 1) % shape.points];
 
-    auto bullet = m_entities.addEntity("bullet");
+        vertices.push_back(ShapeVertex{ sf::Vector2f(), 0, shape.fill });
+        vertices.push_back(ShapeVertex{ u0, shape.radius, shape.fill });
+        vertices.push_back(ShapeVertex{ u1, shape.radius, shape.fill });
 
-    Vec2 vel = mousePos - player->cTransform->pos;
-    vel.normalize();
-    vel *= m_bulletConfig.S;
+        if (shape.outlineThickness > 0)
+        {
+            m_outlineVertices.push_back(ShapeVertex{ u0, shape.radius, shape.outline });
+            m_outlineVertices.push_back(ShapeVertex{ u0, outerRadius, shape.outline });
+            m_outlineVertices.push_back(ShapeVertex{ u1, shape.radius, shape.outline });
+            m_outlineVertices.push_back(ShapeVertex{ u1, shape.radius, shape.outline });
+            m_outlineVertices.push_back(ShapeVertex{ u0, outerRadius, shape.outline });
+            m_outlineVertices.push_back(ShapeVertex{ u1, outerRadius, shape.outline });
+        }
+    }
+
+    // Outline goes on top of this shape's fill, but under the next shape
+    vertices.insert(vertices.end(), m_outlineVertices.begin(), m_outlineVertices.end());
+    m_outlineVertices.clear();
+}
+
+/**
+ * Turns a shape's unrotated triangles by its angle and moves them to where it is.
+ * 
+ * local    - the triangles (see appendLocalVertices())
+ * count    - how many vertices there are
+ * shape    - the shape
+ * c        - cosine of its angle
+ * s        - sine of its angle
+ * vertices - where to add the placed triangles
+ */
+void Game::placeVertices(const ShapeVertex * local, size_t count, const RenderShape & shape, float c, float s, std::vector<sf::Vertex> & vertices)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const sf::Vector2f & u = local[i].direction;
+        const sf::Vector2f d(u.x * c - u.y * s, u.x * s + u.y * c);
+        vertices.push_back(sf::Vertex(sf::Vector2f(shape.x + d.x * local[i].distance, shape.y + d.y * local[i].distance), local[i].color));
+    }
+}
 
-    bullet->cTransform = std::make_shared<CTransform>(player->cTransform->pos, vel, 0);
-    bullet->cCollision = std::make_shared<CCollision>(m_bulletConfig.CR);
-    bullet->cShape = std::make_shared<CShape>(m_bulletConfig.SR, m_bulletConfig.V, sf::Color(m_bulletConfig.FR, m_bulletConfig.FG, m_bulletConfig.FB, 255), sf::Color(m_bulletConfig.OR, m_bulletConfig.OG, m_bulletConfig.OB, 255), m_bulletConfig.OT);
-    bullet->cLifespan = std::make_shared<CLifespan>(m_bulletConfig.L);
+/**
+ * Returns the special weapon (nuke) cool down indicator for the HUD: a miniature version of the actual nuke, faded
+ * when it's not available.
+ * 
+ * ready - true if the nuke can be used
+ */
+RenderShape Game::nukeIndicator(bool ready) const
+{
+    const int alpha = ready ? 255 : 255 * 0.40;
+
+    // Miniature version w/ same proportions
+    const float explosionRadius = 10;
+    const float blastRadius = explosionRadius * m_nukeConfig.BR / m_nukeConfig.ER;
+
+    RenderShape shape;
+    shape.x = 15 + explosionRadius;
+    shape.y = 50 + explosionRadius;
+    shape.radius = explosionRadius;
+    shape.outlineThickness = blastRadius - explosionRadius;
+    shape.points = m_nukeConfig.V;
+    shape.fill = sf::Color(m_nukeConfig.FR, m_nukeConfig.FG, m_nukeConfig.FB, alpha);
+    shape.outline = sf::Color(m_nukeConfig.OR, m_nukeConfig.OG, m_nukeConfig.OB, alpha);
+    return shape;
 }
 
 /**
- * Spawn special weapon (nuke).
+ * Spawns the particles the simulation asked for since the last frame, and moves all particles.
  * 
- * Spawns special weapon on top of player.
+ * snapshot - what is being drawn this frame
+ * dt       - seconds since the last frame
  */
-void Game::spawnSpecialWeapon(std::shared_ptr<Entity> entity)
+void Game::updateParticles(const RenderSnapshot & snapshot, float dt)
 {
-    // Nuke spawns on top of player.
+    Burst burst;
+    while (m_bursts.pop(burst))
+    {
+        // Under load, fewer particles
+        if (snapshot.qualityLevel >= FrameGovernor::REDUCED_SHAPES)
+        {
+            burst.count = (burst.count + 1) / 2;
+        }
 
-    auto nuke = m_entities.addEntity("nuke");
-    sf::Color fill = sf::Color(m_nukeConfig.FR, m_nukeConfig.FG, m_nukeConfig.FB);
-    sf::Color outline = sf::Color(m_nukeConfig.OR, m_nukeConfig.OG, m_nukeConfig.OB);
+        m_particles.spawn(burst);
+    }
+
+    m_particles.update(dt);
+
+    m_particleVertices.clear();
+    m_particles.appendVertices(m_particleVertices);
+}
 
-    nuke->cTransform = std::make_shared<CTransform>(entity->cTransform->pos, Vec2(0,0), 0);
-    nuke->cShape = std::make_shared<CShape>(m_nukeConfig.ER, m_nukeConfig.V, fill, outline, m_nukeConfig.BR - m_nukeConfig.ER);
-    nuke->cLifespan = std::make_shared<CLifespan>(m_nukeConfig.L);
+/**
+ * Draws particles (as glowing lines, in one draw call).
+ */
+void Game::drawParticles()
+{
+    if (!m_particleVertices.empty())
+    {
+        m_window.draw(m_particleVertices.data(), m_particleVertices.size(), sf::Lines, sf::RenderStates(sf::BlendAdd));
+    }
 }
 
 /**
- * Spawns a big enemy.
+ * Draws the debug overlay: collision circles and the spawn grid over the scene, and a panel with a frame time
+ * graph, the systems' costs, entity counts, pool usage, and collision counts.
+ * 
+ * The overlay shows what it cost itself to draw (the previous frame's, this frame's isn't known until it's drawn).
+ * 
+ * snapshot - the frame being drawn (with its DebugInfo)
  */
-void Game::spawnEnemy()
+void Game::drawDebugOverlay(const RenderSnapshot & snapshot)
 {
-    auto enemy = m_entities.addEntity("enemy");
+    Stopwatch stopwatch;
+    const DebugInfo & debug = snapshot.debug;
+
+    m_debugTriangles.clear();
+    m_debugLines.clear();
 
-    // Spawn position
-    float x, y;
+    auto line = [this](float x1, float y1, float x2, float y2, const sf::Color & color)
+    {
+        m_debugLines.push_back(sf::Vertex(sf::Vector2f(x1, y1), color));
+        m_debugLines.push_back(sf::Vertex(sf::Vector2f(x2, y2), color));
+    };
+    auto rectangle = [this](float x, float y, float width, float height, const sf::Color & color)
+    {
+        const sf::Vertex topLeft(sf::Vector2f(x, y), color);
+        const sf::Vertex topRight(sf::Vector2f(x + width, y), color);
+        const sf::Vertex bottomRight(sf::Vector2f(x + width, y + height), color);
+        const sf::Vertex bottomLeft(sf::Vector2f(x, y + height), color);
+        m_debugTriangles.insert(m_debugTriangles.end(), { topLeft, topRight, bottomRight, topLeft, bottomRight, bottomLeft });
+    };
 
-    if (m_player != nullptr && !m_startMenu)
+    // Spawn grid (as of the last spawn): cells an enemy couldn't spawn in are shaded
+    const sf::Color gridColor(90, 90, 200, 90);
+    const sf::Color blockedColor(200, 60, 60, 45);
+    const float cell = debug.gridCellSize;
+    for (int i = 0; i < (int) debug.gridFree.size(); i++)
+    {
+        if (!debug.gridFree[i])
+        {
+            rectangle(debug.gridX + (i % debug.gridCols) * cell, debug.gridY + (i / debug.gridCols) * cell, cell, cell, blockedColor);
+        }
+    }
+    for (int col = 0; col <= debug.gridCols && debug.gridRows > 0; col++)
     {
-        // Enemy can't spawn on top or near the player (just reroll a new random spawn point)
+        line(debug.gridX + col * cell, debug.gridY, debug.gridX + col * cell, debug.gridY + debug.gridRows * cell, gridColor);
+    }
+    for (int row = 0; row <= debug.gridRows && debug.gridCols > 0; row++)
+    {
+        line(debug.gridX, debug.gridY + row * cell, debug.gridX + debug.gridCols * cell, debug.gridY + row * cell, gridColor);
+    }
 
-        float reroll = true;
-        const float noSpawnZoneRadius = m_player->cCollision->radius * 3;
-        while (reroll)
+    // Collision circles
+    const int circlePoints = 24;
+    const sf::Color circleColor(80, 255, 80, 200);
+    const std::vector<sf::Vector2f> & polygon = unitPolygon(circlePoints);
+    for (size_t i = 0; i + 2 < debug.circles.size(); i += 3)
+    {
+        const float x = debug.circles[i];
+        const float y = debug.circles[i + 1];
+        const float r = debug.circles[i + 2];
+        for (int k = 0; k < circlePoints; k++)
         {
-            // enemies can't spawn outside or PARTLY outside map, must be fully in
-            x = randFromRange(m_enemyConfig.SR, m_window.getSize().x - m_enemyConfig.SR);
-            y = randFromRange(m_enemyConfig.SR, m_window.getSize().y - m_enemyConfig.SR);
-            
-            if (!isOverlap(m_player->cTransform->pos, Vec2(x,y), noSpawnZoneRadius, m_enemyConfig.SR))
-            {
-                reroll = false;
-            }
+            const sf::Vector2f & a = polygon[k];
+            const sf::Vector2f & b = polygon[(k + 1) % circlePoints];
+            line(x + a.x * r, y + a.y * r, x + b.x * r, y + b.y * r, circleColor);
         }
     }
-    else
+
+    // The grid and circles are in the world (drawn through the camera), the rest is on the window
+    m_window.setView(sf::View(sf::FloatRect(snapshot.cameraX, snapshot.cameraY, m_window.getSize().x, m_window.getSize().y)));
+    if (!m_debugTriangles.empty())
+    {
+        m_window.draw(m_debugTriangles.data(), m_debugTriangles.size(), sf::Triangles);
+    }
+    if (!m_debugLines.empty())
+    {
+        m_window.draw(m_debugLines.data(), m_debugLines.size(), sf::Lines);
+    }
+    m_window.setView(m_window.getDefaultView());
+    m_debugTriangles.clear();
+    m_debugLines.clear();
+
+    // Panel (top right)
+    const float panelWidth = 340;
+    const float panelHeight = 320;
+    const float panelX = m_window.getSize().x - panelWidth - 10;
+    const float panelY = 10;
+    rectangle(panelX, panelY, panelWidth, panelHeight, sf::Color(0, 0, 0, 180));
+
+    // Frame time graph (newest on the right, frames that missed their deadline in red), with a line at the frame budget
+    const float graphX = panelX + 10;
+    const float graphBottom = panelY + panelHeight - 10;
+    const float graphMaxMs = 50;
+    const float pixelsPerMs = 60 / graphMaxMs;
+    const float barSpacing = (panelWidth - 20) / DEBUG_FRAME_HISTORY;
+    const float budgetMs = 1000.0f / m_windowConfig.FL;
+    float worstMs = 0;
+    for (int i = 0; i < DEBUG_FRAME_HISTORY; i++)
+    {
+        const float ms = m_debugFrameTimes[(m_debugFrameIndex + i) % DEBUG_FRAME_HISTORY];
+        const float barHeight = std::min(ms, graphMaxMs) * pixelsPerMs;
+        const sf::Color barColor = ms > budgetMs + FramePacer::MISS_SLACK_MS ? sf::Color(255, 80, 80) : sf::Color(80, 200, 255);
+        rectangle(graphX + i * barSpacing, graphBottom - barHeight, barSpacing * 0.8f, barHeight, barColor);
+        worstMs = std::max(worstMs, ms);
+    }
+    line(graphX, graphBottom - budgetMs * pixelsPerMs, graphX + DEBUG_FRAME_HISTORY * barSpacing, graphBottom - budgetMs * pixelsPerMs, sf::Color(255, 255, 255, 160));
+
+    m_window.draw(m_debugTriangles.data(), m_debugTriangles.size(), sf::Triangles);
+    if (!m_debugLines.empty())
+    {
+        m_window.draw(m_debugLines.data(), m_debugLines.size(), sf::Lines);
+    }
+
+    // Numbers
+    static const char * const TAG_NAMES[PERF_TAG_COUNT] = { "players", "enemies", "bullets", "nukes" };
+
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(2);
+    text << "DEBUG (F3)     overlay " << m_debugOverlayCost << " ms\n";
+    text << "frame " << m_debugFrameTimes[(m_debugFrameIndex + DEBUG_FRAME_HISTORY - 1) % DEBUG_FRAME_HISTORY] << " ms"
+         << "  worst " << worstMs << " ms\n";
+    text << "quality " << FrameGovernor::levelName((FrameGovernor::Level) snapshot.qualityLevel)
+         << "  budget used " << (int) (debug.pressure * 100) << "%\n";
+    for (int system = 0; system < FrameGovernor::SYSTEM_COUNT; system += 2)
+    {
+        text << "  " << FrameGovernor::systemName((FrameGovernor::System) system) << " " << debug.systemMs[system] << " ms";
+        if (system + 1 < FrameGovernor::SYSTEM_COUNT)
+        {
+            text << "   " << FrameGovernor::systemName((FrameGovernor::System) (system + 1)) << " " << debug.systemMs[system + 1] << " ms";
+        }
+        text << "\n";
+    }
+    for (int tag = 0; tag < PERF_TAG_COUNT; tag++)
+    {
+        text << TAG_NAMES[tag] << " " << debug.entities[tag] << (tag + 1 < PERF_TAG_COUNT ? "  " : "\n");
+    }
+    text << "collision pairs " << debug.collisionTests << " tested, " << debug.collisionHits << " hit\n";
+    text << "ai enemies thought " << debug.aiThought << " (budget " << m_aiConfig.BUDGET << " us)  flow field builds " << debug.flowFieldBuilds << "\n";
+    text << "shapes " << m_shapesDrawn << ", rebuilt " << m_shapesRebuilt << " (the rest were only turned and moved)\n";
+    text << "pools: contacts " << debug.collisionHits << "/" << debug.contactCapacity
+         << "  particles " << m_particles.liveCount() << "/" << m_particles.capacity() << "\n";
+    text << "sound voices " << m_audio.busyVoices() << "/" << m_audio.voices() << "  dropped " << m_audio.dropped() << "\n";
+
+    sf::Text numbers;
+    numbers.setFont(m_font);
+    numbers.setString(text.str());
+    numbers.setCharacterSize(12);
+    numbers.setColor(sf::Color::White);
+    numbers.setPosition(sf::Vector2f(panelX + 10, panelY + 8));
+    m_window.draw(numbers);
+
+    m_debugOverlayCost = stopwatch.lap();
+}
+
+/**
+ * Returns the corners of a regular polygon with the given number of corners, with radius 1 and centered at (0,0),
+ * in the same order SFML's sf::CircleShape has them (first one at the top).
+ * 
+ * The last element is not a corner: its x is cos(pi/points) (used to size outlines).
+ */
+const std::vector<sf::Vector2f> & Game::unitPolygon(int points)
+{
+    if (points >= (int) m_unitPolygons.size())
+    {
+        m_unitPolygons.resize(points + 1);
+    }
+
+    std::vector<sf::Vector2f> & polygon = m_unitPolygons[points];
+    if (polygon.empty())
     {
-        // Player is not spawned, so it safe to spawn anywhere
+        for (int k = 0; k < points; k++)
+        {
+            float s, c;
+            fastmath::sincosDeg(k * 360.0f / points - 90, s, c);
+            polygon.push_back(sf::Vector2f(c, s));
+        }
 
-        // enemies can't spawn outside or PARTLY outside map, must be fully in
-        x = randFromRange(m_enemyConfig.SR, m_window.getSize().x - m_enemyConfig.SR);
-        y = randFromRange(m_enemyConfig.SR, m_window.getSize().y - m_enemyConfig.SR);
+        float s, c;
+        fastmath::sincosDeg(180.0f / points, s, c);
+        polygon.push_back(sf::Vector2f(c, 0));
     }
 
-    // Random speed, random diagonal direction, and random number of vertices
-    const float componentSpeed = std::sqrt(randFromRange(m_enemyConfig.SMIN, m_enemyConfig.SMAX) * 2);
-    const int velXSign = std::rand() % 2 == 0 ? 1 : -1;
-    const int velYSign = std::rand() % 2 == 0 ? 1 : -1;
-    const int shapePoints = randFromRange(m_enemyConfig.VMIN, m_enemyConfig.VMAX);
+    return polygon;
+}
+
+/**
+ * Plays the sound effects the simulation asked for since the last frame.
+ * 
+ * dt - seconds since the last frame
+ */
+void Game::playSounds(float dt)
+{
+    m_audio.update(dt);
+
+    SoundEffect effect;
+    while (m_soundEffects.pop(effect))
+    {
+        m_audio.play(effect);
+    }
+}
 
-    enemy->cTransform = std::make_shared<CTransform>(Vec2(x,y), Vec2(componentSpeed * velXSign, componentSpeed * velYSign), 0.0f);
-    enemy->cShape = std::make_shared<CShape>(m_enemyConfig.SR, shapePoints, sf::Color(randFromRange(0,255),randFromRange(0,255),randFromRange(0,255)), sf::Color(m_enemyConfig.OR,m_enemyConfig.OG,m_enemyConfig.OB), m_enemyConfig.OT);
-    enemy->cInput = std::make_shared<CInput>();
-    enemy->cCollision = std::make_shared<CCollision>(m_enemyConfig.CR);
-    enemy->cScore = std::make_shared<CScore>(m_enemyConfig.SNE);
+/**
+ * Sends a sound effect to the render thread (which plays it).
+ */
+void Game::emitSound(const SoundEffect & effect)
+{
+    // Like particles, not again for ticks re-simulated by a rollback
+    if (!m_netResimulating)
+    {
+        m_soundEffects.push(effect);
+    }
+}
 
-    m_lastEnemySpawnTime = m_currentFrame;
+/**
+ * Sends a burst of particles to the render thread (particles are only for looks, the simulation doesn't keep them).
+ */
+void Game::emitBurst(const Burst & burst)
+{
+    // Netplay re-simulating ticks it already simulated (rollback) would show the same effect twice
+    if (!m_netResimulating)
+    {
+        m_bursts.push(burst);
+    }
 }
@@ -1,55 +1,200 @@
+#pragma once
+
 #include <SFML/Graphics.hpp>
-#include "EntityManager.h"
-#include "Entity.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include "Alloc.h"
+#include "Audio.h"
+#include "FramePacer.h"
+#include "GameSim.h"
+#include "Governor.h"
+#include "Input.h"
+#include "Net.h"
+#include "Particles.h"
+#include "PerfCounters.h"
+#include "Stats.h"
+#include "RenderSnapshot.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+
+
+const size_t PARTICLE_CAPACITY = 256 * 1024;
+
+// Netplay: two games on this machine (127.0.0.1) play co-op, each controlling one player. DELAY and LOSS are applied to outgoing packets (for testing).
+struct NetConfig { bool ENABLED = false; int PLAYER = 0, LOCAL_PORT = 7000, REMOTE_PORT = 7001, DELAY = 0, LOSS = 0; unsigned SEED = 1; };
+
+// PACING: how frames are paced in the window (see FramePacer), at WindowConfig's FL frames per second.
+// Headless mode: plays TICKS ticks without a window, and saves the last frame (software rendered with THREADS threads, 0 is one per core) to OUTPUT (.png or .ppm).
+// ENEMIES: extra enemies spawned all over the world when headless mode starts (for stress testing big worlds).
+// EXPECT: the image's known good checksum (hex), if it's to be checked (headless mode fails if the image's is different).
+struct RenderConfig { FramePacer::Mode PACING = FramePacer::FIXED; bool HEADLESS = false; int TICKS = 300, THREADS = 0, ENEMIES = 0; std::string OUTPUT = "frame.png", EXPECT; };
 
+const int NET_HISTORY       = 64;   // ticks of inputs & saved states kept for rollback
+const int NET_MAX_ROLLBACK  = 8;    // how many ticks the game can run ahead of the other player's inputs before it waits
+const int NET_MAX_RESEND    = 32;   // most inputs sent in one packet
 
-struct PlayerConfig { int SR = 32, CR = 32, FR = 5, FG = 5, FB = 5, OR = 255, OG = 0, OB = 0, OT = 4, V = 8; float S = 5; };
-struct EnemyConfig { int SR = 32, CR = 32, OR = 255, OG = 255, OB = 255, OT = 2, VMIN = 3, VMAX = 8, L = 90, SI = 60, SNE = 50, SSE = 125; float SMIN = 3, SMAX = 6; };
-struct BulletConfig { int SR = 10, CR = 10, FR = 255, FG = 255, FB = 255, OR = 255, OG = 255, OB = 255, OT = 2, V = 20, L = 90; float S = 20; };
-struct NukeConfig { int V = 20, ER = 150, BR = 300, L = 40, REL = 150, FR = 232, FG = 100, FB = 61, OR = 192, OG = 192, OB = 192, CDI = 100; float BVM = 3; };
+const size_t MAX_TRACKED_INPUTS = 32;   // simulated input events kept in snapshots (for measuring latency)
+const int    DEBUG_FRAME_HISTORY = 120;  // frames in the debug overlay's frame time graph
 
-class Game
+class SoftwareRenderer;
+
+/**
+ * The game: a GameSim, with a window (or headless rendering) and netplay.
+ */
+class Game : public GameSim
 {
 public:
-    Game();
-    void run();
+    Game(const NetConfig & netConfig = NetConfig(), const RenderConfig & renderConfig = RenderConfig(), const WorldConfig & worldConfig = WorldConfig(), const AudioConfig & audioConfig = AudioConfig());
+    int run();
 
 private:
     sf::RenderWindow    m_window;
-    EntityManager       m_entities;
     sf::Font            m_font;
     sf::Text            m_text;
-    PlayerConfig        m_playerConfig;
-    EnemyConfig         m_enemyConfig;
-    BulletConfig        m_bulletConfig;
-    NukeConfig          m_nukeConfig;
-    int                 m_currentFrame          = 0;
-    int                 m_lastEnemySpawnTime    = 0;
-    int                 m_lastNukeTime          = 0;
+    NetConfig           m_netConfig;
+    RenderConfig        m_renderConfig;
+    AudioConfig         m_audioConfig;
+    GovernorConfig      m_governorConfig;
+    FrameGovernor       m_governor              { m_governorConfig };
     bool                m_paused                = false;
-    bool                m_running               = true;
-    bool                m_startMenu             = true;
-    bool                m_endGameMenu           = false;
+    std::atomic<bool>   m_running               { true };
     float               m_startMenuInstructionAlphaPercent = 1;
-    int                 m_highScore             = 0;
-    int                 m_gameScore             = 0;
-    bool                m_isNewHighScore        = false;
-    int                 m_diffNewHighScorePrevHighScore = 0;
+    std::chrono::steady_clock::time_point m_startTime;
+    bool                m_firstFrameShown       = false;
+    float               m_cameraX               = 0;    // top left corner of the part of the world the window shows
+    float               m_cameraY               = 0;
+
+    PlayerInput         m_localInput;
+
+    // Input latency
+    std::vector<std::chrono::steady_clock::time_point>  m_localInputTimes;          // events in m_localInput, not yet simulated
+    std::deque<std::chrono::steady_clock::time_point>   m_simulatedInputTimes;      // events simulated recently (newest last)
+    std::chrono::steady_clock::time_point               m_lastPresentedInputTime;   // render thread only
+    Distribution        m_inputSimulatedLatency;
+    Distribution        m_inputPresentedLatency;                                    // render thread only
+
+    // Netplay
+    NetPeer             m_net;
+    int                 m_netTick               = 0;    // next tick to simulate
+    int                 m_netRemoteConfirmed    = -1;   // last tick we have the other player's actual input for
+    int                 m_netRemoteAck          = -1;   // last tick of our inputs the other player has
+    PlayerInput         m_netInputs[MAX_PLAYERS][NET_HISTORY];
+    SavedState          m_netStates[NET_HISTORY];
+    bool                m_netResimulating       = false;    // rolling back (re-simulating ticks already simulated once)
 
-    std::shared_ptr<Entity> m_player;
+    // Performance counters published to shared memory (for watching a running game with PerfMonitor.exe)
+    PerfWriter          m_perf;
+    PerfFrame           m_perfFrame;                // this tick's, being filled in
+    std::uint64_t       m_perfAllocations       = 0;    // totals at the last tick, to get each tick's share
+    std::uint64_t       m_perfAllocatedBytes    = 0;
+    size_t              m_perfAdded             = 0;
+    size_t              m_perfRemoved           = 0;
+    std::uint64_t       m_perfCollisionTests    = 0;
+    std::uint64_t       m_perfCollisionHits     = 0;
+
+    // Allocations by each system (render is written by the render thread only)
+    std::uint64_t       m_systemAllocations[FrameGovernor::SYSTEM_COUNT]    = {};
+    std::uint64_t       m_systemAllocatedBytes[FrameGovernor::SYSTEM_COUNT] = {};
+    std::atomic<std::uint64_t> m_renderAllocations { 0 };   // by the last frame
+    long                m_simulatedTicks        = 0;
+
+    // Between the simulation thread and the render thread
+    TripleBuffer<RenderSnapshot>    m_snapshots;
+    SpscQueue<TimedEvent, 256>      m_events;
+    SpscQueue<Burst, 4096>          m_bursts;
+    SpscQueue<SoundEffect, 1024>    m_soundEffects;
+
+    // A corner of a shape's triangles before it's turned and moved into place: direction from the shape's center
+    // (unrotated, 0 for the center itself), how far along it, and its color
+    struct ShapeVertex
+    {
+        sf::Vector2f    direction;
+        float           distance;
+        sf::Color       color;
+    };
+
+    // Render thread only (kept around so they don't get reallocated every frame)
+    std::vector<float>  m_renderAngles;
+    std::vector<float>  m_renderSines;
+    std::vector<float>  m_renderCosines;
+    std::vector<sf::Vertex> m_shapeVertices;
+    std::vector<ShapeVertex> m_outlineVertices;
+    std::vector<RenderShape> m_hudShapes;
+    AudioSystem         m_audio;                        // offline (mixed by runHeadless()) in headless mode
+
+    // Entities' unrotated triangles as of the last frame drawn, reused while an entity's version stays the same (see buildEntityVertices())
+    struct CachedShape
+    {
+        size_t          id;
+        std::uint32_t   version;
+        std::uint32_t   first;      // its vertices in m_localVertices
+        std::uint32_t   count;
+    };
+    std::vector<CachedShape> m_cachedShapes;            // in entity order
+    std::vector<CachedShape> m_nextCachedShapes;
+    std::vector<ShapeVertex> m_localVertices;
+    std::vector<ShapeVertex> m_nextLocalVertices;
+    std::vector<ShapeVertex> m_shapeScratch;            // one shape's, for shapes that aren't cached
+    std::vector<sf::Vertex> m_entityVertices;           // this frame's, turned and moved into place
+    std::uint32_t       m_cachedStateLoads      = 0;
+    int                 m_cachedQualityLevel    = 0;
+    int                 m_cachedScene           = RenderSnapshot::START_MENU;
+    int                 m_shapesDrawn           = 0;    // last frame
+    int                 m_shapesRebuilt         = 0;
+    std::vector<std::vector<sf::Vector2f>> m_unitPolygons;
+    long                m_renderFrame           = 0;
+    int                 m_hudScore              = 0;
+    bool                m_hudNukeReady          = true;
+    std::atomic<double> m_renderCost            { 0 };  // ms the last frame took to draw (read by the simulation's governor)
+    FramePacer          m_pacer;
+
+    // Debug overlay (toggled with F3 on the render thread, the simulation only fills in DebugInfo while it's on)
+    std::atomic<bool>   m_debugOverlay          { false };
+    float               m_debugFrameTimes[DEBUG_FRAME_HISTORY] = {};    // ms between frames, render thread only
+    int                 m_debugFrameIndex       = 0;
+    std::chrono::steady_clock::time_point m_debugLastFrame;
+    double              m_debugOverlayCost      = 0;    // ms the overlay took to draw last frame
+    std::vector<sf::Vertex> m_debugTriangles;
+    std::vector<sf::Vertex> m_debugLines;
+    ParticleSystem      m_particles             { PARTICLE_CAPACITY };
+    std::vector<sf::Vertex> m_particleVertices;
+    std::chrono::steady_clock::time_point m_lastParticleUpdate;
 
     void init();
+    int runHeadless();
+    void buildDrawList(const RenderSnapshot & snapshot, SoftwareRenderer & renderer);
+    void renderLoop();
+    void simulationLoop();
+    void tick();
+    void publishSnapshot();
+    void updateCamera();
+    void publishPerf();
+    void fillDebugInfo(DebugInfo & debug);
+    void addSystemCost(FrameGovernor::System system, Stopwatch & stopwatch, alloc::Counter & allocs) override;
+    void netplayTick();
+    PlayerInput takeLocalInput();
 
-    void sMovement();
     void sUserInput();
-    void sLifespan();
-    void sRender();
-    void sEnemySpawner();
-    void sCollision();
-
-    void spawnPlayer();
-    void spawnEnemy();
-    void spawnSmallEnemies(std:: shared_ptr<Entity> bigEnemy);
-    void spawnBullet(std::shared_ptr<Entity> player, const Vec2 & mousePos);
-    void spawnSpecialWeapon(std::shared_ptr<Entity> entity);
+    void sRender(const RenderSnapshot & snapshot);
+    bool setMovementKey(sf::Keyboard::Key key, bool pressed);
+
+    void drawWorld(const RenderSnapshot & snapshot);
+    void drawShapes(const std::vector<RenderShape> & shapes);
+    void buildShapeVertices(const std::vector<RenderShape> & shapes, std::vector<sf::Vertex> & vertices);
+    const std::vector<sf::Vertex> & buildEntityVertices(const RenderSnapshot & snapshot);
+    void appendShapeVertices(const RenderShape & shape, float c, float s, std::vector<sf::Vertex> & vertices);
+    void appendLocalVertices(const RenderShape & shape, std::vector<ShapeVertex> & vertices);
+    void placeVertices(const ShapeVertex * local, size_t count, const RenderShape & shape, float c, float s, std::vector<sf::Vertex> & vertices);
+    RenderShape nukeIndicator(bool ready) const;
+    const std::vector<sf::Vector2f> & unitPolygon(int points);
+    void updateParticles(const RenderSnapshot & snapshot, float dt);
+    void drawParticles();
+    void drawDebugOverlay(const RenderSnapshot & snapshot);
+
+    void playSounds(float dt);
+
+    void emitBurst(const Burst & burst) override;
+    void emitSound(const SoundEffect & effect) override;
 };
\ No newline at end of file
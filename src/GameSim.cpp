@@ -0,0 +1,1478 @@
+#include "GameSim.h"
+#include "FastMath.h"
+#include "Alloc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+
+/**
+ * Checks if two circles are overlapping.
+ * 
+ * Use this function instead of overlap() if all you need to known is if two circles overlap
+ * because it is more efficient at doing this calculation.
+ * 
+ * pos1 - center of circle 1
+ * pos2 - center of circle 2
+ * r1   - radius of circle 1
+ * r2   - radius of circle 2
+ */
+bool isOverlap(Vec2 pos1, Vec2 pos2, Real r1, Real r2)
+{
+    // Apparently, calculating the square root of a number is very expensive. So instead we just compare distances squared.
+    return pos1.distSqr(pos2) < (r1 + r2) * (r1 + r2);
+}
+
+/**
+ * Returns the overlap or distance between the two circles.
+ * 
+ * If the overlap is greater than 0, then the returned value is the overlap of the two circles.
+ * 
+ * If the overlap is less then or equal to 0, then it means the two circles are not overlapping,
+ * and the absolute value of this overlap is the distance between the two circles. To be specific,
+ * this distance is the distance between the two centers of the circles minus both their radiuses.
+ * 
+ * pos1 - center of circle 1
+ * pos2 - center of circle 2
+ * r1   - radius of circle 1
+ * r2   - radius of circle 2
+ */
+Real overlap(Vec2 pos1, Vec2 pos2, Real r1, Real r2)
+{
+    return (r1 + r2) - pos1.dist(pos2);
+}
+
+/**
+ * Returns v scaled to a length of 1 (v itself if it has no length).
+ */
+Vec2 direction(Vec2 v)
+{
+    if (v.lengthSqr() > Real(0))
+    {
+        v.normalize();
+    }
+    return v;
+}
+
+/**
+ * Returns how many ticks something moving along one axis goes before it touches a wall (0 if it already does), at
+ * most max.
+ * 
+ * pos    - position on the axis
+ * vel    - velocity on the axis
+ * radius - its radius
+ * size   - where the far wall is (the near one is at 0)
+ * max    - most ticks to return
+ */
+int ticksBeforeWall(Real pos, Real vel, float radius, int size, int max)
+{
+    if (pos - radius <= 0 || pos + radius >= size)
+    {
+        return 0;
+    }
+    if (vel == Real(0))
+    {
+        return max;
+    }
+
+    const float room = toFloat(vel > Real(0) ? size - radius - pos : pos - radius);
+    return (int) std::min((float) max, std::ceil(room / std::abs(toFloat(vel))));
+}
+
+/**
+ * Creates a simulation, with its players spawned and in game (not in the start menu).
+ * 
+ * simConfig   - seed, players, and how the AI is run
+ * worldConfig - size of the world (the window's size by default)
+ * enemyConfig - enemies (spawning, speed, score)
+ * nukeConfig  - the nuke (size, cooldown, blast)
+ */
+GameSim::GameSim(const SimConfig & simConfig, const WorldConfig & worldConfig, const EnemyConfig & enemyConfig, const NukeConfig & nukeConfig)
+    : m_simConfig(simConfig)
+    , m_enemyConfig(enemyConfig)
+    , m_nukeConfig(nukeConfig)
+    , m_worldConfig(worldConfig)
+    , m_random(simConfig.SEED)
+    , m_flowField(simConfig.THREADS)
+{
+    // The world is never smaller than the window
+    m_worldConfig.W = std::max(m_worldConfig.W, m_windowConfig.W);
+    m_worldConfig.H = std::max(m_worldConfig.H, m_windowConfig.H);
+
+    m_collisionGrid.build(nullptr, 0, m_enemyConfig.CR * 2.0f, (float) m_worldConfig.W, (float) m_worldConfig.H);
+
+    for (int player = 0; player < m_simConfig.PLAYERS; player++)
+    {
+        spawnPlayer(player);
+    }
+}
+
+/**
+ * Runs one tick of the game simulation.
+ * 
+ * Same systems as the in-game scene (or game over scene, once the game is over), minus rendering and window input.
+ * 
+ * inputs - what each player did this tick
+ */
+void GameSim::simulate(const PlayerInput inputs[MAX_PLAYERS])
+{
+    // Each system's cost is tracked by the frame budget governor (and what it allocated by the performance counters)
+    Stopwatch stopwatch;
+    alloc::Counter allocs;
+
+    if (m_endGameMenu)
+    {
+        m_entities.update();
+        addSystemCost(FrameGovernor::UPDATE, stopwatch, allocs);
+        updateFlowField();
+        addSystemCost(FrameGovernor::AI, stopwatch, allocs);
+        sMovement();
+        addSystemCost(FrameGovernor::MOVEMENT, stopwatch, allocs);
+        sCollision();
+        addSystemCost(FrameGovernor::COLLISION, stopwatch, allocs);
+        sLifespan();
+        addSystemCost(FrameGovernor::LIFESPAN, stopwatch, allocs);
+        return;
+    }
+
+    sPlayerInput(inputs);
+    addSystemCost(FrameGovernor::INPUT, stopwatch, allocs);
+    m_entities.update();
+    addSystemCost(FrameGovernor::UPDATE, stopwatch, allocs);
+    sEnemySpawner();
+    addSystemCost(FrameGovernor::SPAWNER, stopwatch, allocs);
+    updateFlowField();
+    addSystemCost(FrameGovernor::AI, stopwatch, allocs);
+    sMovement();
+    addSystemCost(FrameGovernor::MOVEMENT, stopwatch, allocs);
+    sCollision();
+    addSystemCost(FrameGovernor::COLLISION, stopwatch, allocs);
+    sAI();
+    addSystemCost(FrameGovernor::AI, stopwatch, allocs);
+    sLifespan(); // must be last system call (in order for nuke to work) [What?]
+    addSystemCost(FrameGovernor::LIFESPAN, stopwatch, allocs);
+
+    m_currentFrame++;
+}
+
+/**
+ * Called after each system simulate() runs, with the stopwatch and allocation counter lapped when it started. The
+ * simulation on its own doesn't keep track (Game gives the costs to its frame budget governor).
+ * 
+ * system    - the system
+ * stopwatch - lapped when the system started
+ * allocs    - lapped when the system started
+ */
+void GameSim::addSystemCost(FrameGovernor::System /*system*/, Stopwatch & /*stopwatch*/, alloc::Counter & /*allocs*/)
+{
+}
+
+/**
+ * Saves everything the simulation changes.
+ */
+void GameSim::saveState(SavedState & state)
+{
+    state.entities.copyFrom(m_entities);
+    state.random = m_random;
+    state.currentFrame = m_currentFrame;
+    state.movementTick = m_movementTick;
+    std::copy(m_lodFocus, m_lodFocus + MAX_PLAYERS, state.lodFocus);
+    state.lodFocusCount = m_lodFocusCount;
+    state.aiCursor = m_aiCursor;
+    state.lastEnemySpawnTime = m_lastEnemySpawnTime;
+    state.lastNukeTime = m_lastNukeTime;
+    state.endGameMenu = m_endGameMenu;
+    state.highScore = m_highScore;
+    state.gameScore = m_gameScore;
+    state.isNewHighScore = m_isNewHighScore;
+    state.diffNewHighScorePrevHighScore = m_diffNewHighScorePrevHighScore;
+    state.playerId = m_player != nullptr ? (long) m_player->id() : -1;
+}
+
+/**
+ * Restores a state saved by saveState().
+ */
+void GameSim::loadState(const SavedState & state)
+{
+    m_entities.copyFrom(state.entities);
+    m_stateLoads++;
+    m_random = state.random;
+    m_currentFrame = state.currentFrame;
+    m_movementTick = state.movementTick;
+    std::copy(state.lodFocus, state.lodFocus + MAX_PLAYERS, m_lodFocus);
+    m_lodFocusCount = state.lodFocusCount;
+    m_aiCursor = state.aiCursor;
+    m_lastEnemySpawnTime = state.lastEnemySpawnTime;
+    m_lastNukeTime = state.lastNukeTime;
+    m_endGameMenu = state.endGameMenu;
+    m_highScore = state.highScore;
+    m_gameScore = state.gameScore;
+    m_isNewHighScore = state.isNewHighScore;
+    m_diffNewHighScorePrevHighScore = state.diffNewHighScorePrevHighScore;
+    m_player = state.playerId >= 0 ? m_entities.getEntity(state.playerId) : nullptr;
+
+    // The enemies are back where they were (the spawn grid isn't saved, it counts them again)
+    addEnemiesToSpawnGrid();
+}
+
+/**
+ * Returns the current score (in co-op, the players share their score).
+ */
+int GameSim::currentScore()
+{
+    int score = 0;
+    for (auto p : m_entities.getEntities("player"))
+    {
+        score = std::max(score, p->cScore->score);
+    }
+    return score;
+}
+
+/**
+ * Returns true once every player is dead (the game over scene: enemies keep moving, but nothing else happens).
+ */
+bool GameSim::isOver() const
+{
+    return m_endGameMenu;
+}
+
+/**
+ * Returns how many ticks have been played (game over ones not included).
+ */
+int GameSim::currentFrame() const
+{
+    return m_currentFrame;
+}
+
+/**
+ * Returns the score: the players' while they play, and the game's once it's over (the players are gone by then).
+ */
+int GameSim::score()
+{
+    return m_endGameMenu ? m_gameScore : currentScore();
+}
+
+/**
+ * Returns a hash of the entities (tags, positions and velocities) and the score, for checking that two simulations
+ * played out the same.
+ */
+std::uint64_t GameSim::checksum()
+{
+    // FNV-1a over the bytes
+    std::uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const void * data, size_t size)
+    {
+        const unsigned char * bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+
+    add(&m_currentFrame, sizeof(m_currentFrame));
+    const int points = score();
+    add(&points, sizeof(points));
+    for (auto e : m_entities.getEntities())
+    {
+        add(e->tag().data(), e->tag().size());
+        add(&e->cTransform->pos, sizeof(Vec2));
+        add(&e->cTransform->velocity, sizeof(Vec2));
+    }
+    return hash;
+}
+
+/**
+ * Writes where every entity is into arrays (the C API's observation, see GeoWars.h): position, radius, and tag (0
+ * player, 1 enemy, 2 bullet, 3 nuke), players first, then enemies, bullets and nukes. Returns how many it wrote.
+ * 
+ * x        - centres
+ * y
+ * radius   - collision radii (a nuke's is its explosion's)
+ * tag      - tags
+ * capacity - size of the arrays (entities past it are left out)
+ */
+int GameSim::observe(float * x, float * y, float * radius, std::uint8_t * tag, int capacity)
+{
+    alloc::NoAlloc noAlloc("observe");
+
+    int count = 0;
+    const char * const TAGS[] = { "player", "enemy", "bullet", "nuke" };
+    for (std::uint8_t t = 0; t < 4; t++)
+    {
+        for (const std::shared_ptr<Entity> & e : m_entities.getEntities(TAGS[t]))
+        {
+            if (count == capacity)
+            {
+                return count;
+            }
+            if (!e->isActive())
+            {
+                continue;
+            }
+
+            x[count] = toFloat(e->cTransform->pos.x);
+            y[count] = toFloat(e->cTransform->pos.y);
+            radius[count] = e->cCollision != nullptr ? toFloat(e->cCollision->radius) : e->cShape->circle.getRadius();
+            tag[count] = t;
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Returns what the scripted player does on a tick (headless and batch mode): walks in a square, shoots all around,
+ * and uses the nuke once.
+ * 
+ * tick     - the tick
+ * nukeTick - the tick it uses the nuke on
+ */
+PlayerInput GameSim::botInput(int tick, int nukeTick) const
+{
+    PlayerInput input;
+    input.up = tick / 60 % 4 == 3;
+    input.right = tick / 60 % 4 == 0;
+    input.down = tick / 60 % 4 == 1;
+    input.left = tick / 60 % 4 == 2;
+    if (tick % 6 == 0 && m_player != nullptr)
+    {
+        float s, c;
+        fastmath::sincosDeg(tick * 23.0f, s, c);
+        input.shoot = true;
+        input.aimX = toFloat(m_player->cTransform->pos.x) + c * 100;
+        input.aimY = toFloat(m_player->cTransform->pos.y) + s * 100;
+    }
+    input.nuke = tick == nukeTick;
+    return input;
+}
+
+/**
+ * Gives points to every player that is still alive.
+ */
+void GameSim::addScore(int score)
+{
+    for (auto p : m_entities.getEntities("player"))
+    {
+        if (p->isActive())
+        {
+            p->cScore->score += score;
+        }
+    }
+}
+
+/**
+ * System for collisions.
+ *
+ * Runs in two passes: detection only reads positions and records every contact in m_contacts, then
+ * the responses (scoring, killing, splitting, bouncing) are applied in the order the contacts were
+ * recorded. Nothing detection reads is changed until it's done, so it could be split between threads
+ * without changing the result.
+ */
+void GameSim::sCollision()
+{
+    m_contacts.clear();
+    reserveCollisions();
+    detectCollisions();
+    m_totalCollisionHits += m_contacts.size();
+
+    for (const Contact & c : m_contacts)
+    {
+        switch (c.type)
+        {
+            case Contact::BULLET_ENEMY:     onBulletHit(c); break;
+            case Contact::PLAYER_ENEMY:     onPlayerHit(c); break;
+            case Contact::NUKE_EXPLOSION:
+            case Contact::NUKE_BLAST:       onNukeHit(c); break;
+            case Contact::ENEMY_ENEMY:      onEnemiesBounce(c); break;
+        }
+    }
+
+    // Game is over once every player is dead
+    if (!m_endGameMenu && !m_entities.getEntities("player").empty())
+    {
+        int score = 0;
+        bool anyAlive = false;
+        for (auto p : m_entities.getEntities("player"))
+        {
+            score = std::max(score, p->cScore->score);
+            anyAlive = anyAlive || p->isActive();
+        }
+
+        if (!anyAlive)
+        {
+            m_endGameMenu = true;
+
+            if (score > m_highScore)
+            {
+                m_diffNewHighScorePrevHighScore = score - m_highScore;
+                m_highScore = score;
+                m_isNewHighScore = true;
+            }
+
+            m_gameScore = score;
+        }
+    }
+}
+
+/**
+ * Makes room in collision detection's buffers for every enemy there is now (and a contact for each of them, and for
+ * every bullet and player), so detectCollisions() doesn't allocate. They only ever grow, and then to at least twice
+ * what they were, so a world filling up with enemies reallocates them a handful of times, not every tick.
+ */
+void GameSim::reserveCollisions()
+{
+    const size_t enemies = m_entities.getEntities("enemy").size();
+    const size_t contacts = enemies + m_entities.getEntities("bullet").size() + m_entities.getEntities("player").size();
+
+    if (m_collisionPos.capacity() < enemies)
+    {
+        const size_t room = std::max(enemies, m_collisionPos.capacity() * 2);
+        m_collisionPos.reserve(room);
+        m_collisionRadius.reserve(room);
+        m_collisionGhost.reserve(room);
+        m_collisionMoved.reserve(room);
+        m_collisionCandidates.reserve(room);
+        m_collisionGrid.reserve((std::uint32_t) room);
+    }
+    if (m_contacts.capacity() < contacts)
+    {
+        m_contacts.reserve(std::max(contacts, m_contacts.capacity() * 2));
+    }
+}
+
+/**
+ * Finds every contact this tick and appends it to m_contacts (sCollision()'s detection pass).
+ *
+ * Enemy positions and radii are copied into flat arrays first, so the inner loops go through
+ * contiguous memory instead of following a pointer per enemy per check. They're then sorted into a uniform grid
+ * (m_collisionGrid) so each check only looks at the enemies nearby, not every enemy in the world. The grid gives
+ * candidates in no particular order, so they're sorted back into enemy order first: contacts come out exactly as
+ * if every enemy had been checked (which keeps rollback and the headless checksums deterministic).
+ */
+void GameSim::detectCollisions()
+{
+    alloc::NoAlloc noAlloc("detectCollisions");
+
+    const EntityVec & enemies = m_entities.getEntities("enemy");
+    const std::uint32_t enemyCount = (std::uint32_t) enemies.size();
+
+    m_collisionPos.resize(enemyCount);
+    m_collisionRadius.resize(enemyCount);
+    m_collisionGhost.resize(enemyCount);
+    m_collisionMoved.resize(enemyCount);
+    Real maxRadius = m_enemyConfig.CR;
+    for (std::uint32_t i = 0; i < enemyCount; i++)
+    {
+        m_collisionPos[i] = enemies[i]->cTransform->pos;
+        m_collisionRadius[i] = enemies[i]->cCollision->radius;
+        // Enemies with lifespans can not collide with other enemies (they are ghosts)
+        m_collisionGhost[i] = enemies[i]->cLifespan != nullptr;
+        // Enemies far from the players don't move every tick (see sMovement()), nor check for each other until they do
+        m_collisionMoved[i] = enemies[i]->cTransform->movedAt == m_movementTick;
+        maxRadius = std::max(maxRadius, m_collisionRadius[i]);
+    }
+
+    // Cells twice a big enemy's radius (the same as in init(), so building the grid doesn't allocate): an
+    // enemy-enemy check looks at 2x2 or 3x3 cells
+    m_collisionGrid.build(m_collisionPos.data(), enemyCount, m_enemyConfig.CR * 2.0f, (float) m_worldConfig.W, (float) m_worldConfig.H);
+
+    // Pairs checked, for the performance counters
+    std::uint32_t tests = 0;
+
+    // Bullet-enemy collision (a bullet hits the first enemy it overlaps)
+    const EntityVec & bullets = m_entities.getEntities("bullet");
+    for (std::uint32_t b = 0; b < bullets.size(); b++)
+    {
+        const Vec2 pos = bullets[b]->cTransform->pos;
+        const Real radius = bullets[b]->cCollision->radius;
+
+        std::uint32_t first = enemyCount;
+        m_collisionGrid.query(toFloat(pos.x), toFloat(pos.y), toFloat(radius + maxRadius), [&](std::uint32_t e)
+        {
+            tests++;
+            if (e < first && isOverlap(pos, m_collisionPos[e], radius, m_collisionRadius[e]))
+            {
+                first = e;
+            }
+        });
+        if (first < enemyCount)
+        {
+            addContact({ Contact::BULLET_ENEMY, b, first });
+        }
+    }
+
+    // Player-enemy collision
+    const EntityVec & players = m_entities.getEntities("player");
+    for (std::uint32_t p = 0; p < players.size(); p++)
+    {
+        if (!players[p]->isActive())
+        {
+            continue;
+        }
+
+        const Vec2 pos = players[p]->cTransform->pos;
+        const Real radius = players[p]->cCollision->radius;
+
+        std::uint32_t first = enemyCount;
+        m_collisionGrid.query(toFloat(pos.x), toFloat(pos.y), toFloat(radius + maxRadius), [&](std::uint32_t e)
+        {
+            tests++;
+            if (e < first && isOverlap(pos, m_collisionPos[e], radius, m_collisionRadius[e]))
+            {
+                first = e;
+            }
+        });
+        if (first < enemyCount)
+        {
+            addContact({ Contact::PLAYER_ENEMY, p, first });
+        }
+    }
+
+    // Nuke-Enemy collision
+    const EntityVec & nukes = m_entities.getEntities("nuke");
+    for (std::uint32_t n = 0; n < nukes.size(); n++)
+    {
+        // Nuke only works during its first frame (not the best way to do this, but it works)
+        if (nukes[n]->cLifespan->remaining != nukes[n]->cLifespan->total)
+        {
+            continue;
+        }
+
+        const Vec2 pos = nukes[n]->cTransform->pos;
+
+        m_collisionCandidates.clear();
+        m_collisionGrid.query(toFloat(pos.x), toFloat(pos.y), (float) m_nukeConfig.BR, [&](std::uint32_t e)
+        {
+            m_collisionCandidates.push_back(e);
+        });
+        std::sort(m_collisionCandidates.begin(), m_collisionCandidates.end());
+
+        tests += (std::uint32_t) m_collisionCandidates.size();
+        for (std::uint32_t e : m_collisionCandidates)
+        {
+            // Enemy is in explosion if its center is inside the explosion radius
+            bool isInExplosion = isOverlap(m_collisionPos[e], pos, m_nukeConfig.ER, 0);
+            // Enemy is in blast (shockwave) if its center is inside the blast (shockwave) radius
+            bool isInBlast = isOverlap(m_collisionPos[e], pos, m_nukeConfig.BR, 0);
+
+            // Any enemy in the explosion radius dies
+            // Enemies with 'lifespan' die if they are in blast or explosion radius
+            if (isInExplosion || (isInBlast && m_collisionGhost[e]))
+            {
+                addContact({ Contact::NUKE_EXPLOSION, n, e });
+            }
+            else if (isInBlast)
+            {
+                addContact({ Contact::NUKE_BLAST, n, e });
+            }
+        }
+    }
+
+    // Enemy-enemy collision (each pair once, ghosts skipped, and pairs where neither moved this tick)
+    for (std::uint32_t e1 = 0; e1 < enemyCount; e1++)
+    {
+        if (m_collisionGhost[e1] || !m_collisionMoved[e1])
+        {
+            continue;
+        }
+
+        m_collisionCandidates.clear();
+        m_collisionGrid.query(toFloat(m_collisionPos[e1].x), toFloat(m_collisionPos[e1].y), toFloat(m_collisionRadius[e1] + maxRadius), [&](std::uint32_t e2)
+        {
+            if ((e2 > e1 || !m_collisionMoved[e2]) && !m_collisionGhost[e2])
+            {
+                m_collisionCandidates.push_back(e2);
+            }
+        });
+        std::sort(m_collisionCandidates.begin(), m_collisionCandidates.end());
+
+        tests += (std::uint32_t) m_collisionCandidates.size();
+        for (std::uint32_t e2 : m_collisionCandidates)
+        {
+            if (isOverlap(m_collisionPos[e1], m_collisionPos[e2], m_collisionRadius[e1], m_collisionRadius[e2]))
+            {
+                addContact({ Contact::ENEMY_ENEMY, e1, e2 });
+            }
+        }
+    }
+
+    m_collisionTests = (int) tests;
+    m_totalCollisionTests += tests;
+}
+
+/**
+ * Adds a contact. reserveCollisions() leaves room for a contact per enemy, which is only ever not enough when a nuke
+ * goes off or enemies pile up (each overlapping several others): then the list grows, as an allocation that's
+ * expected (it's kept, so it doesn't happen again for as many).
+ */
+void GameSim::addContact(const Contact & contact)
+{
+    if (m_contacts.size() == m_contacts.capacity())
+    {
+        alloc::AllowAlloc allowAlloc;
+        m_contacts.reserve(m_contacts.size() * 2 + 1);
+    }
+    m_contacts.push_back(contact);
+}
+
+/**
+ * A bullet hit an enemy: both die, the player scores, and a big enemy splits into small ones.
+ */
+void GameSim::onBulletHit(const Contact & contact)
+{
+    auto b = m_entities.getEntities("bullet")[contact.a];
+    auto e = m_entities.getEntities("enemy")[contact.b];
+
+    // Big enemies spawn smaller enemies
+    if (e->cLifespan == nullptr)
+    {
+        spawnSmallEnemies(e);
+        emitSound(SoundEffect{ SoundEffect::SPLIT });
+    }
+    emitExplosion(e);
+    emitSound(SoundEffect{ SoundEffect::KILL, e->cShape->circle.getRadius() / m_enemyConfig.SR });
+
+    // Player scores points for killing enemy
+    addScore(e->cScore->score);
+
+    b->destroy();
+    destroyEnemy(e);
+}
+
+/**
+ * An enemy hit a player: the player dies.
+ */
+void GameSim::onPlayerHit(const Contact & contact)
+{
+    auto p = m_entities.getEntities("player")[contact.a];
+
+    emitExplosion(p);
+    emitSound(SoundEffect{ SoundEffect::DEATH });
+    p->destroy();
+    if (p == m_player)
+    {
+        m_player = nullptr;
+    }
+}
+
+/**
+ * An enemy is in a nuke's explosion (it dies), or in its blast.
+ */
+void GameSim::onNukeHit(const Contact & contact)
+{
+    auto n = m_entities.getEntities("nuke")[contact.a];
+    auto e = m_entities.getEntities("enemy")[contact.b];
+
+    if (contact.type == Contact::NUKE_EXPLOSION)
+    {
+        addScore(e->cScore->score);
+
+        emitExplosion(e);
+        emitSound(SoundEffect{ SoundEffect::KILL, e->cShape->circle.getRadius() / m_enemyConfig.SR });
+        destroyEnemy(e);
+        return;
+    }
+
+    // A enemy in blast radius is given a 'lifespan' (i.e they will die after a certain amount of time passes),
+    // their speed is multiplied by the blast speed multiplier (BVM) (i.e their given a speed boost),
+    // and they are given a higher score value (i.e player gets more for killing these types of enemies)
+
+    // (an enemy right on the nuke's centre is pushed the way it was already going)
+    Real newSpeed = e->cTransform->velocity.length() * m_nukeConfig.BVM;
+    Vec2 newVelocity = direction(e->cTransform->pos - n->cTransform->pos);
+    if (newVelocity == Vec2())
+    {
+        newVelocity = direction(e->cTransform->velocity);
+    }
+    newVelocity *= newSpeed;
+
+    e->cLifespan = std::make_shared<CLifespan>(m_nukeConfig.REL);
+    e->cTransform->velocity = newVelocity;
+    e->cScore->score = m_enemyConfig.SSE;
+    e->cTransform->angularVel *= -5;
+    e->cShape->version++;   // it fades from now on
+}
+
+/**
+ * Two enemies collided: they bounce off each other.
+ */
+void GameSim::onEnemiesBounce(const Contact & contact)
+{
+    auto e1 = m_entities.getEntities("enemy")[contact.a];
+    auto e2 = m_entities.getEntities("enemy")[contact.b];
+
+    // A nuke's blast may have turned one into a ghost since the contact was found
+    if (e1->cLifespan != nullptr || e2->cLifespan != nullptr)
+    {
+        return;
+    }
+
+    // Enemies that collide change direction and go in exact opposite directions of each other, but same speed as each started with
+
+    // (enemies on top of each other part the way they were moving apart, or along x if they were moving together)
+    Vec2 newDirectionForE1 = direction(e1->cTransform->pos - e2->cTransform->pos);
+    if (newDirectionForE1 == Vec2())
+    {
+        newDirectionForE1 = direction(e1->cTransform->velocity - e2->cTransform->velocity);
+    }
+    if (newDirectionForE1 == Vec2())
+    {
+        newDirectionForE1 = Vec2(1, 0);
+    }
+
+    e1->cTransform->velocity = newDirectionForE1 * e1->cTransform->velocity.length();
+    e2->cTransform->velocity = newDirectionForE1 * (e2->cTransform->velocity.length() * -1);
+
+    // Separate the two so that their is no overlap anymore, each the way it's going now (one that isn't moving has no
+    // way to go, and dividing by its zero speed would fault with fixed-point math: it's moved straight apart instead)
+    Real halfOverlap = overlap(e1->cTransform->pos, e2->cTransform->pos, e1->cCollision->radius, e2->cCollision->radius)/2; 
+    const Real speed1 = e1->cTransform->velocity.length();
+    const Real speed2 = e2->cTransform->velocity.length();
+    if (speed1 > Real(0))
+    {
+        e1->cTransform->pos.addScaled(e1->cTransform->velocity, halfOverlap/speed1);
+    }
+    else
+    {
+        e1->cTransform->pos.addScaled(newDirectionForE1, halfOverlap);
+    }
+    if (speed2 > Real(0))
+    {
+        e2->cTransform->pos.addScaled(e2->cTransform->velocity, halfOverlap/speed2);
+    }
+    else
+    {
+        e2->cTransform->pos.addScaled(newDirectionForE1, -halfOverlap);
+    }
+
+    e1->cTransform->spawnCell = m_spawnGrid.move(e1->cTransform->spawnCell, toFloat(e1->cTransform->pos.x), toFloat(e1->cTransform->pos.y));
+    e2->cTransform->spawnCell = m_spawnGrid.move(e2->cTransform->spawnCell, toFloat(e2->cTransform->pos.x), toFloat(e2->cTransform->pos.y));
+}
+
+/**
+ * Builds the flow field to the (active) players again if one of them moved to another cell. Chasers steer down it
+ * in sMovement(), so it's only ever worked out from the current state (netplay rollback doesn't need to save it).
+ */
+void GameSim::updateFlowField()
+{
+    float x[MAX_PLAYERS];
+    float y[MAX_PLAYERS];
+    int count = 0;
+    for (auto p : m_entities.getEntities("player"))
+    {
+        if (p->isActive() && count < MAX_PLAYERS)
+        {
+            x[count] = toFloat(p->cTransform->pos.x);
+            y[count] = toFloat(p->cTransform->pos.y);
+            count++;
+        }
+    }
+
+    m_flowField.update(x, y, count, (float) m_worldConfig.W, (float) m_worldConfig.H, (float) m_aiConfig.FC);
+}
+
+/**
+ * System for enemy AI: works out how enemies with a behaviour steer (sMovement() does the steering).
+ * 
+ * Working out steering is the expensive part, so only some enemies do it each tick, taking turns (round robin), and
+ * the rest keep steering the way they last worked out. It stops once the tick's budget (AiConfig's BUDGET) is used
+ * up, however many enemies there are. Only enemies near a player think (far away they're simulated in less detail,
+ * see sMovement()).
+ * 
+ * Runs right after sCollision(), while the enemies' positions and the collision grid are still this tick's (so
+ * flocking looks up neighbours in the grid instead of going through every enemy).
+ */
+void GameSim::sAI()
+{
+    alloc::NoAlloc noAlloc("sAI");
+
+    const EntityVec & enemies = m_entities.getEntities("enemy");
+    const std::uint32_t enemyCount = (std::uint32_t) std::min(enemies.size(), m_collisionPos.size());
+
+    // Enemies go after the nearest player
+    Vec2 targets[MAX_PLAYERS];
+    int targetCount = 0;
+    for (auto p : m_entities.getEntities("player"))
+    {
+        if (p->isActive() && targetCount < MAX_PLAYERS)
+        {
+            targets[targetCount++] = p->cTransform->pos;
+        }
+    }
+
+    m_aiThought = 0;
+    if (targetCount == 0)
+    {
+        return;
+    }
+
+    // Netplay and headless games count enemies instead of time (with the clock, each game would think differently)
+    const bool counted = m_simConfig.DETERMINISTIC;
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(m_aiConfig.BUDGET);
+    const Real nearSquared = Real(m_lodConfig.NR) * m_lodConfig.NR;
+
+    for (std::uint32_t scanned = 0; scanned < enemyCount; scanned++)
+    {
+        // Out of budget? (the clock is only read every few enemies, reading it isn't free)
+        if (counted ? m_aiThought >= m_aiConfig.QUOTA : scanned % 16 == 15 && std::chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+
+        if (m_aiCursor >= enemyCount)
+        {
+            m_aiCursor = 0;
+        }
+        const std::uint32_t i = m_aiCursor++;
+
+        // Ghosts (enemies with lifespans) just fly off, and enemies far from every player don't think
+        if (m_collisionGhost[i])
+        {
+            continue;
+        }
+        int nearest = 0;
+        for (int t = 1; t < targetCount; t++)
+        {
+            if (m_collisionPos[i].distSqr(targets[t]) < m_collisionPos[i].distSqr(targets[nearest]))
+            {
+                nearest = t;
+            }
+        }
+        if (m_collisionPos[i].distSqr(targets[nearest]) >= nearSquared)
+        {
+            continue;
+        }
+
+        // (chasers don't need to think, they have the flow field)
+        const std::shared_ptr<Entity> & e = enemies[i];
+        if (e->cBehaviour == nullptr || e->cBehaviour->type == CBehaviour::SEEK || e->cLifespan != nullptr || !e->isActive())
+        {
+            continue;
+        }
+
+        e->cBehaviour->steering = think(i, *e->cBehaviour, e->cTransform->velocity, targets[nearest]);
+        e->cBehaviour->thoughtAt = m_movementTick;
+        m_aiThought++;
+    }
+}
+
+/**
+ * Works out an enemy's steering for its behaviour: the change to its velocity per tick (sMovement() keeps its
+ * speed the same, only its direction changes).
+ * 
+ * enemy     - index of the enemy (in the enemy list, and the collision arrays)
+ * behaviour - the enemy's behaviour
+ * velocity  - the enemy's velocity
+ * target    - position of the player it's after
+ */
+Vec2 GameSim::think(std::uint32_t enemy, const CBehaviour & behaviour, const Vec2 & velocity, const Vec2 & target)
+{
+    const Vec2 pos = m_collisionPos[enemy];
+    const Real speed = velocity.length();
+    const Vec2 toTarget = direction(target - pos);
+
+    switch (behaviour.type)
+    {
+        case CBehaviour::FLOCK:
+        {
+            // Towards the middle of the enemies around it, the way they're going, and away from ones too close
+            // (drifting towards the player)
+            const EntityVec & enemies = m_entities.getEntities("enemy");
+            const Real radius = m_aiConfig.FR;
+            Vec2 centre;
+            Vec2 heading;
+            Vec2 separation;
+            int neighbours = 0;
+            m_collisionGrid.query(toFloat(pos.x), toFloat(pos.y), (float) m_aiConfig.FR, [&](std::uint32_t other)
+            {
+                if (other == enemy || m_collisionGhost[other])
+                {
+                    return;
+                }
+                const Real distance = pos.dist(m_collisionPos[other]);
+                if (distance >= radius)
+                {
+                    return;
+                }
+                centre += m_collisionPos[other];
+                heading += enemies[other]->cTransform->velocity;
+                separation += direction(pos - m_collisionPos[other]) * ((radius - distance) / radius);
+                neighbours++;
+            });
+
+            Vec2 steer = toTarget;
+            if (neighbours > 0)
+            {
+                centre /= Real(neighbours);
+                steer += direction(centre - pos) + direction(heading) + separation;
+            }
+            return direction(steer) * (speed * m_aiConfig.FLOCK);
+        }
+
+        case CBehaviour::ORBIT:
+        {
+            // Around the player (the way it's already going round), moving in or out to the orbit's radius
+            Vec2 around(toTarget.y * -1, toTarget.x);
+            if (around.dot(velocity) < Real(0))
+            {
+                around *= Real(-1);
+            }
+            const Real outOfOrbit = (pos.dist(target) - m_aiConfig.OR) / m_aiConfig.OR;
+            const Real inOrOut = std::max(Real(-1), std::min(Real(1), outOfOrbit));
+            return direction(around + toTarget * inOrOut) * (speed * m_aiConfig.ORBIT);
+        }
+
+        case CBehaviour::DODGE:
+        {
+            // Sideways out of the way of bullets coming at it (or else after the player)
+            const Real dodgeSquared = Real(m_aiConfig.DR) * m_aiConfig.DR;
+            Vec2 dodge;
+            for (auto b : m_entities.getEntities("bullet"))
+            {
+                const Vec2 away = pos - b->cTransform->pos;
+                if (away.lengthSqr() >= dodgeSquared || away.dot(b->cTransform->velocity) <= Real(0))
+                {
+                    continue;
+                }
+
+                // The part of away that's across the bullet's path (any way across, if it's dead on)
+                const Vec2 path = direction(b->cTransform->velocity);
+                Vec2 across = away - path * away.dot(path);
+                if (across.lengthSqr() <= Real(0))
+                {
+                    across = Vec2(path.y * -1, path.x);
+                }
+                dodge += direction(across);
+            }
+
+            if (dodge.lengthSqr() > Real(0))
+            {
+                return direction(dodge) * (speed * m_aiConfig.DODGE);
+            }
+            return toTarget * (speed * m_aiConfig.SEEK);
+        }
+
+        default:
+        {
+            return Vec2();
+        }
+    }
+}
+
+/**
+ * System for movement.
+ */
+void GameSim::sMovement()
+{
+    alloc::NoAlloc noAlloc("sMovement");
+
+    m_movementTick++;
+
+    // Everything spins (enemies when they move)
+    for (const char * tag : { "player", "bullet", "nuke" })
+    {
+        for (auto e : m_entities.getEntities(tag))
+        {
+            e->cTransform->angle += e->cTransform->angularVel;
+        }
+    }
+
+    // Player movement
+    for (auto player : m_entities.getEntities("player"))
+    {
+        std::shared_ptr<CInput> playerCI = player->cInput;
+        std::shared_ptr<CTransform> playerCT = player->cTransform;
+        const float radius = player->cShape->circle.getRadius();
+        CInput actualMovementInput;
+
+        playerCT->velocity = {0,0}; // zero out player velocity
+
+        // Things to take into account when determining actual movement input:
+        // 1) Directions that are opposite of each other cancel each other (like up and down)
+        // 2) Player can not move out of bounds, so cancel movement that would move player out of bounds
+        actualMovementInput.up = (playerCI->up && !playerCI->down) && (playerCT->pos.y - radius >= 0);
+        actualMovementInput.down = (playerCI->down && !playerCI->up) && (playerCT->pos.y + radius <= m_worldConfig.H);
+        actualMovementInput.left = (playerCI->left && !playerCI->right) && (playerCT->pos.x - radius >= 0);
+        actualMovementInput.right = (playerCI->right && !playerCI->left) && (playerCT->pos.x + radius <= m_worldConfig.W);
+
+        if ((actualMovementInput.up || actualMovementInput.down) && (actualMovementInput.left || actualMovementInput.right)) // moving diagonally
+        {
+            // Moving diagonally should have same speed as moving horizontally or vertically
+
+            const float componentSpeed = std::sqrt(m_playerConfig.S * 2);
+
+            if (actualMovementInput.up) // up
+            {
+                playerCT->velocity.y -= componentSpeed;
+            }
+            else // down
+            {
+                playerCT->velocity.y += componentSpeed;
+            }
+
+            if (actualMovementInput.left) // left
+            {
+                playerCT->velocity.x -= componentSpeed;
+            }
+            else // right
+            {
+                playerCT->velocity.x += componentSpeed;
+            }
+        }
+        else // moving horizontally or vertically
+        {
+            if (actualMovementInput.up) // moving up
+            {
+                playerCT->velocity.y -= m_playerConfig.S;
+            }
+            else if (actualMovementInput.down) // moving down
+            {
+                playerCT->velocity.y += m_playerConfig.S;
+            }
+            else if (actualMovementInput.left) // moving left
+            {
+                playerCT->velocity.x -= m_playerConfig.S;
+            }
+            else if (actualMovementInput.right) // moving right
+            {
+                playerCT->velocity.x += m_playerConfig.S;
+            }
+        }
+
+        // Move the player
+        playerCT->pos += playerCT->velocity;
+    }
+
+    // Enemy movement
+    // Far from every player, enemies only move every few ticks (staggered by id, so they don't all move on the same
+    // tick), catching up the ticks in between. How far they are is only checked when they move.
+    // Distances are from the players (or where they were last: after they die, the camera stays there)
+    const EntityVec & players = m_entities.getEntities("player");
+    if (!players.empty())
+    {
+        m_lodFocusCount = std::min((int) players.size(), MAX_PLAYERS);
+        for (int p = 0; p < m_lodFocusCount; p++)
+        {
+            m_lodFocus[p] = players[p]->cTransform->pos;
+        }
+    }
+    const Real nearSquared = Real(m_lodConfig.NR) * m_lodConfig.NR;
+    const Real farSquared = Real(m_lodConfig.FR) * m_lodConfig.FR;
+    for (auto e : m_entities.getEntities("enemy")) 
+    {
+        CTransform & transform = *e->cTransform;
+        if (transform.moveAt > m_movementTick)
+        {
+            continue;
+        }
+
+        // Enemies with a behaviour steer, keeping their speed: chasers down the flow field (every time they move), the
+        // others the way sAI() last worked out for them (while it's fresh)
+        if (e->cBehaviour != nullptr && e->cLifespan == nullptr)
+        {
+            const CBehaviour & behaviour = *e->cBehaviour;
+            const bool chaser = behaviour.type == CBehaviour::SEEK;
+            if (chaser || (behaviour.thoughtAt >= 0 && m_movementTick - behaviour.thoughtAt <= m_aiConfig.STALE))
+            {
+                const Real speed = transform.velocity.length();
+                Vec2 steering = behaviour.steering;
+                if (chaser)
+                {
+                    float dx, dy;
+                    m_flowField.direction(toFloat(transform.pos.x), toFloat(transform.pos.y), dx, dy);
+                    steering = Vec2(dx, dy) * (speed * m_aiConfig.SEEK);
+                }
+                transform.velocity = direction(transform.velocity + steering) * speed;
+            }
+        }
+
+        // (new enemies have never moved: they're where they were spawned as of the tick before)
+        moveEnemy(transform, e->cShape->circle.getRadius(), transform.movedAt < 0 ? 1 : m_movementTick - transform.movedAt);
+        transform.movedAt = m_movementTick;
+        transform.spawnCell = m_spawnGrid.move(transform.spawnCell, toFloat(transform.pos.x), toFloat(transform.pos.y));
+
+        // (before there have been any players, nothing is far)
+        Real distanceSquared = m_lodFocusCount == 0 ? Real(0) : farSquared;
+        for (int p = 0; p < m_lodFocusCount; p++)
+        {
+            distanceSquared = std::min(distanceSquared, m_lodFocus[p].distSqr(transform.pos));
+        }
+        const int period = distanceSquared < nearSquared ? 1 : (distanceSquared < farSquared ? m_lodConfig.MP : m_lodConfig.FP);
+        transform.moveAt = m_movementTick + period - (int) ((m_movementTick + e->id()) % period);
+    }
+
+    // Bullet movement
+    for (auto b : m_entities.getEntities("bullet")) 
+    {
+        // Bullets travel in straight directions (they don't bounce of walls. they can go outside the window)
+
+        // Sparks trail behind the bullet
+        Burst trail;
+        trail.x = toFloat(b->cTransform->pos.x);
+        trail.y = toFloat(b->cTransform->pos.y);
+        trail.vx = toFloat(b->cTransform->velocity.x) * m_windowConfig.TR * m_particleConfig.TV;
+        trail.vy = toFloat(b->cTransform->velocity.y) * m_windowConfig.TR * m_particleConfig.TV;
+        trail.speed = m_particleConfig.TS;
+        trail.life = m_particleConfig.TL;
+        trail.count = m_particleConfig.TRAIL;
+        trail.color = b->cShape->circle.getOutlineColor();
+        emitBurst(trail);
+
+        // Move the bullet
+        b->cTransform->pos += b->cTransform->velocity;
+    }
+}
+
+/**
+ * Moves an enemy as many ticks at once, the same as sMovement() would one tick at a time: it spins, and bounces off
+ * the walls on the same ticks. Stretches without a bounce are done in one step.
+ * 
+ * transform - the enemy's
+ * radius    - the enemy's (shape) radius
+ * ticks     - how many ticks to move it
+ */
+void GameSim::moveEnemy(CTransform & transform, float radius, int ticks)
+{
+    Vec2 & pos = transform.pos;
+    Vec2 & vel = transform.velocity;
+
+    while (ticks > 0)
+    {
+        // Up to the tick before the next bounce (one early, so rounding can't skip a bounce)
+        const int free = std::min(ticksBeforeWall(pos.x, vel.x, radius, m_worldConfig.W, ticks), ticksBeforeWall(pos.y, vel.y, radius, m_worldConfig.H, ticks)) - 1;
+        if (free > 0)
+        {
+            transform.angle += transform.angularVel * free;
+            pos.addScaled(vel, Real(free));
+            ticks -= free;
+            continue;
+        }
+
+        // A tick that might bounce: enemies bounce off the walls (they shouldn't go outside the world)
+        transform.angle += transform.angularVel;
+        if (pos.x - radius <= 0 || pos.x + radius >= m_worldConfig.W)
+        {
+            vel.x *= -1;
+            transform.angularVel *= -1;
+        }
+        if (pos.y - radius <= 0 || pos.y + radius >= m_worldConfig.H)
+        {
+            vel.y *= -1;
+            transform.angularVel *= -1;
+        }
+        pos += vel;
+        ticks--;
+    }
+}
+
+/**
+ * System for player input.
+ * 
+ * Applies what each player did this tick to the player entity they control (movement keys, and firing weapons).
+ * 
+ * inputs - what each player did this tick
+ */
+void GameSim::sPlayerInput(const PlayerInput inputs[MAX_PLAYERS])
+{
+    for (auto p : m_entities.getEntities("player"))
+    {
+        const PlayerInput & input = inputs[p->cInput->player];
+
+        p->cInput->up = input.up;
+        p->cInput->left = input.left;
+        p->cInput->down = input.down;
+        p->cInput->right = input.right;
+        p->cInput->shoot = input.shoot;
+
+        if (input.shoot)
+        {
+            spawnBullet(p, Vec2(input.aimX, input.aimY));
+        }
+
+        if (input.nuke && m_currentFrame - m_lastNukeTime >= m_nukeConfig.CDI)
+        {
+            spawnSpecialWeapon(p);
+            m_lastNukeTime = m_currentFrame;
+        }
+    }
+}
+
+/**
+ * System for lifespan.
+ */
+void GameSim::sLifespan()
+{
+    alloc::NoAlloc noAlloc("sLifespan");
+
+    // Entities with lifespans will die once their lifespan is over.
+
+    for (auto e : m_entities.view<CLifespan>())
+    {
+        if (e->cLifespan->remaining > 0) 
+        {
+            e->cLifespan->remaining--;
+            e->cLifespan->version++;
+        } else if (e->tag() == "enemy")
+        {
+            destroyEnemy(e);
+        } else
+        {
+            e->destroy();
+        }
+    }
+}
+
+/**
+ * System for spawning enemies.
+ */
+void GameSim::sEnemySpawner()
+{
+    // 1 enemy is spawned after one 'spawn interval' has passed
+
+    // As a last resort when the game is too expensive, enemies spawn less often (Game throttles it, see Game::tick())
+    const int spawnInterval = m_enemyConfig.SI * m_spawnThrottle;
+    
+    if (m_currentFrame - m_lastEnemySpawnTime >= spawnInterval) {
+        spawnEnemy();
+        m_lastEnemySpawnTime = m_currentFrame;
+    };
+}
+
+/**
+ * Spawns the player.
+ */
+void GameSim::spawnPlayer(int player)
+{
+    auto entity = m_entities.addEntity("player");
+
+    // With more than one player (netplay) they start side by side, and the second player is blue
+    const float x = m_simConfig.PLAYERS > 1 ? m_worldConfig.W * (player + 1) / (MAX_PLAYERS + 1.0f) : m_worldConfig.W / 2.0f;
+    const sf::Color outline = player == 0 ? sf::Color(255,0,0) : sf::Color(0,128,255);
+
+    entity->cTransform = std::make_shared<CTransform>(Vec2(x, m_worldConfig.H / 2.0f), Vec2(3.0f,3.0f), 0.0f);
+    entity->cShape = std::make_shared<CShape>(32.0f, 8, sf::Color(10,10,10), outline, 4.0f);
+    entity->cInput = std::make_shared<CInput>(player);
+    entity->cCollision = std::make_shared<CCollision>(m_playerConfig.CR);
+    entity->cScore = std::make_shared<CScore>(0);
+
+    if (player == m_simConfig.PLAYER)
+    {
+        m_player = entity;
+    }
+    m_isNewHighScore = false;
+}
+
+/**
+ * Spawns 'small' enemies.
+ */
+void GameSim::spawnSmallEnemies(std:: shared_ptr<Entity> bigEnemy)
+{
+    // When a big enemy is killed, it will break up into smaller enemies
+
+    // The number of small enemies to spawn is equal to the number of vertices the big enemy has
+    const int numberOfSmallEnemies = bigEnemy->cShape->circle.getPointCount();
+    const Real speed = bigEnemy->cTransform->velocity.length();
+
+    // Each small enemy goes off in the direction of a vertex (starting from the center of big enemy)
+    m_spawnAngles.resize(numberOfSmallEnemies);
+    m_spawnSines.resize(numberOfSmallEnemies);
+    m_spawnCosines.resize(numberOfSmallEnemies);
+    for (int i = 0; i < numberOfSmallEnemies; i++)
+    {
+        m_spawnAngles[i] = 360/numberOfSmallEnemies * (i) + bigEnemy->cTransform->angle;
+    }
+    using fastmath::sincosDeg;
+    sincosDeg(m_spawnAngles.data(), m_spawnSines.data(), m_spawnCosines.data(), numberOfSmallEnemies);
+
+    for (int i = 0; i < numberOfSmallEnemies; i++) 
+    {
+        const Vec2 vel(speed * m_spawnCosines[i], speed * m_spawnSines[i]);
+
+        auto smallEnemy = m_entities.addEntity("enemy");
+
+        // These smaller enemies spawn where the big enemy died, they are worth double
+        // the points of the big enemy, and have a lifespan
+        smallEnemy->cTransform = std::make_shared<CTransform>(bigEnemy->cTransform->pos, vel, 0);
+        smallEnemy->cCollision = std::make_shared<CCollision>(bigEnemy->cCollision->radius/2);
+        smallEnemy->cShape = std::make_shared<CShape>(bigEnemy->cShape->circle.getRadius()/2, bigEnemy->cShape->circle.getPointCount(), bigEnemy->cShape->circle.getFillColor(), bigEnemy->cShape->circle.getOutlineColor(), bigEnemy->cShape->circle.getOutlineThickness()/2);
+        smallEnemy->cLifespan = std::make_shared<CLifespan>(m_enemyConfig.L);
+        smallEnemy->cScore = std::make_shared<CScore>(m_enemyConfig.SSE);
+        smallEnemy->cTransform->spawnCell = m_spawnGrid.add(toFloat(smallEnemy->cTransform->pos.x), toFloat(smallEnemy->cTransform->pos.y));
+    }
+}
+
+/**
+ * Spawns a bullet.
+ */
+void GameSim::spawnBullet(std::shared_ptr<Entity> player, const Vec2 & mousePos)
+{
+    // Bullet starts off at center of player
+    // It goes towards the direction of the mouse (aiming at the player's own centre has no direction: nothing is fired)
+
+    Vec2 vel = direction(mousePos - player->cTransform->pos);
+    if (vel == Vec2())
+    {
+        return;
+    }
+    vel *= m_bulletConfig.S;
+
+    auto bullet = m_entities.addEntity("bullet");
+
+    bullet->cTransform = std::make_shared<CTransform>(player->cTransform->pos, vel, 0);
+    bullet->cCollision = std::make_shared<CCollision>(m_bulletConfig.CR);
+    bullet->cShape = std::make_shared<CShape>(m_bulletConfig.SR, m_bulletConfig.V, sf::Color(m_bulletConfig.FR, m_bulletConfig.FG, m_bulletConfig.FB, 255), sf::Color(m_bulletConfig.OR, m_bulletConfig.OG, m_bulletConfig.OB, 255), m_bulletConfig.OT);
+    bullet->cLifespan = std::make_shared<CLifespan>(m_bulletConfig.L);
+
+    emitSound(SoundEffect{ SoundEffect::SHOT });
+}
+
+/**
+ * Spawn special weapon (nuke).
+ * 
+ * Spawns special weapon on top of player.
+ */
+void GameSim::spawnSpecialWeapon(std::shared_ptr<Entity> entity)
+{
+    // Nuke spawns on top of player.
+
+    auto nuke = m_entities.addEntity("nuke");
+    sf::Color fill = sf::Color(m_nukeConfig.FR, m_nukeConfig.FG, m_nukeConfig.FB);
+    sf::Color outline = sf::Color(m_nukeConfig.OR, m_nukeConfig.OG, m_nukeConfig.OB);
+
+    nuke->cTransform = std::make_shared<CTransform>(entity->cTransform->pos, Vec2(0,0), 0);
+    nuke->cShape = std::make_shared<CShape>(m_nukeConfig.ER, m_nukeConfig.V, fill, outline, m_nukeConfig.BR - m_nukeConfig.ER);
+    nuke->cLifespan = std::make_shared<CLifespan>(m_nukeConfig.L);
+
+    // Detonation
+    Burst burst;
+    burst.x = toFloat(entity->cTransform->pos.x);
+    burst.y = toFloat(entity->cTransform->pos.y);
+    burst.speed = m_particleConfig.NS;
+    burst.life = m_particleConfig.NL;
+    burst.count = m_particleConfig.NUKE;
+    burst.color = fill;
+    emitBurst(burst);
+    emitSound(SoundEffect{ SoundEffect::NUKE });
+}
+
+/**
+ * Hands a burst of particles to whoever shows them (particles are only for looks, the simulation doesn't keep them).
+ * The simulation on its own has nowhere to show them, so they're dropped.
+ */
+void GameSim::emitBurst(const Burst & /*burst*/)
+{
+}
+
+/**
+ * Hands a sound effect to whoever plays it (like emitBurst(), the simulation on its own drops them).
+ */
+void GameSim::emitSound(const SoundEffect & /*effect*/)
+{
+}
+
+/**
+ * Emits particles for an entity blowing up (in its outline color, bigger entities make more particles).
+ */
+void GameSim::emitExplosion(std::shared_ptr<Entity> entity)
+{
+    const float radius = entity->cShape->circle.getRadius();
+
+    Burst burst;
+    burst.x = toFloat(entity->cTransform->pos.x);
+    burst.y = toFloat(entity->cTransform->pos.y);
+    burst.vx = toFloat(entity->cTransform->velocity.x) * m_windowConfig.TR;
+    burst.vy = toFloat(entity->cTransform->velocity.y) * m_windowConfig.TR;
+    burst.speed = m_particleConfig.KS;
+    burst.life = m_particleConfig.KL;
+    burst.count = std::max(1, (int) (m_particleConfig.KILL * radius / m_enemyConfig.SR));
+    burst.color = entity->cShape->circle.getOutlineColor();
+    emitBurst(burst);
+}
+
+/**
+ * Spawns big enemies, in random places that don't overlap other enemies (or each other).
+ * 
+ * Places are picked from a coarse grid of the cells nothing is in yet. The grid is kept up to date as enemies spawn,
+ * move to another cell, and die (each enemy remembers the cell it's counted in), so spawning never looks at the
+ * enemies already out there, and picking a place is a single random choice however full the world is. If there are
+ * no free cells left, fewer enemies are spawned.
+ * 
+ * count - how many enemies to spawn
+ */
+void GameSim::spawnEnemy(int count)
+{
+    // enemies can't spawn outside or PARTLY outside map, must be fully in (the grid only has cells fully inside)
+    if (m_spawnGrid.fit(m_worldConfig.W, m_worldConfig.H, m_enemyConfig.SG, m_enemyConfig.SR))
+    {
+        addEnemiesToSpawnGrid();
+    }
+
+    // Enemy can't spawn on top or near a player (in the start menu the player is not playing yet, so it's safe to spawn anywhere).
+    // The zones stay blocked until the next spawn (so the debug overlay shows them).
+    m_spawnGrid.clearBlocks();
+    if (!m_startMenu)
+    {
+        for (auto p : m_entities.getEntities("player"))
+        {
+            if (p->isActive())
+            {
+                const Real noSpawnZoneRadius = p->cCollision->radius * 3;
+                m_spawnGrid.block(toFloat(p->cTransform->pos.x), toFloat(p->cTransform->pos.y), toFloat(noSpawnZoneRadius));
+            }
+        }
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        float x, y;
+        const int cell = m_spawnGrid.take(m_random, x, y);
+        if (cell < 0)
+        {
+            break;
+        }
+
+        auto enemy = m_entities.addEntity("enemy");
+
+        // Random speed, random diagonal direction, and random number of vertices
+        const float componentSpeed = std::sqrt(m_random.fromRange(m_enemyConfig.SMIN, m_enemyConfig.SMAX) * 2);
+        const int velXSign = m_random.fromRange(0, 1) == 0 ? 1 : -1;
+        const int velYSign = m_random.fromRange(0, 1) == 0 ? 1 : -1;
+        const int shapePoints = m_random.fromRange(m_enemyConfig.VMIN, m_enemyConfig.VMAX);
+
+        enemy->cTransform = std::make_shared<CTransform>(Vec2(x,y), Vec2(componentSpeed * velXSign, componentSpeed * velYSign), 0.0f);
+        enemy->cShape = std::make_shared<CShape>(m_enemyConfig.SR, shapePoints, sf::Color(m_random.fromRange(0,255),m_random.fromRange(0,255),m_random.fromRange(0,255)), sf::Color(m_enemyConfig.OR,m_enemyConfig.OG,m_enemyConfig.OB), m_enemyConfig.OT);
+        enemy->cInput = std::make_shared<CInput>();
+        enemy->cCollision = std::make_shared<CCollision>(m_enemyConfig.CR);
+        enemy->cScore = std::make_shared<CScore>(m_enemyConfig.SNE);
+        enemy->cBehaviour = std::make_shared<CBehaviour>((CBehaviour::Type) m_random.fromRange(0, CBehaviour::TYPE_COUNT - 1));
+        enemy->cTransform->spawnCell = cell;
+    }
+
+    m_lastEnemySpawnTime = m_currentFrame;
+}
+
+/**
+ * Counts every enemy in the spawn grid again, from scratch (after the grid is set up again, or the enemies are put
+ * back by a netplay rollback). Everywhere else, enemies are counted as they change.
+ */
+void GameSim::addEnemiesToSpawnGrid()
+{
+    m_spawnGrid.removeAll();
+    for (auto e : m_entities.getEntities("enemy"))
+    {
+        e->cTransform->spawnCell = e->isActive() ? m_spawnGrid.add(toFloat(e->cTransform->pos.x), toFloat(e->cTransform->pos.y)) : -1;
+    }
+}
+
+/**
+ * Destroys an enemy, and stops counting it in the spawn grid (its cell is free for spawning straight away).
+ * 
+ * enemy - the enemy (destroying one that already is does nothing more)
+ */
+void GameSim::destroyEnemy(std::shared_ptr<Entity> enemy)
+{
+    m_spawnGrid.remove(enemy->cTransform->spawnCell);
+    enemy->cTransform->spawnCell = -1;
+    enemy->destroy();
+}
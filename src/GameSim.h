@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstdint>
+#include "Alloc.h"
+#include "EntityManager.h"
+#include "Entity.h"
+#include "FlowField.h"
+#include "Governor.h"
+#include "Input.h"
+#include "Particles.h"
+#include "Random.h"
+#include "SoundEffect.h"
+#include "SpatialGrid.h"
+#include "SpawnGrid.h"
+#include "Stats.h"
+
+
+struct PlayerConfig { int SR = 32, CR = 32, FR = 5, FG = 5, FB = 5, OR = 255, OG = 0, OB = 0, OT = 4, V = 8; float S = 5; };
+// SG: size of the spawn grid's cells (enemies spawn at most one per cell, any room over 2 * SR is random jitter).
+struct EnemyConfig { int SR = 32, CR = 32, OR = 255, OG = 255, OB = 255, OT = 2, VMIN = 3, VMAX = 8, L = 90, SI = 60, SNE = 50, SSE = 125, SG = 80; float SMIN = 3, SMAX = 6; };
+struct BulletConfig { int SR = 10, CR = 10, FR = 255, FG = 255, FB = 255, OR = 255, OG = 255, OB = 255, OT = 2, V = 20, L = 90; float S = 20; };
+struct WindowConfig { int W = 1280, H = 720, FL = 60, TR = 60; };
+// The world the game is played in (the window shows the part around the player). 0 (or anything smaller than the window) is the window's size.
+struct WorldConfig { int W = 0, H = 0; };
+// Simulation level of detail: enemies further than NR from every player move every MP ticks, and further than FR every FP ticks
+// (catching up all the ticks at once, bounces included), and only collide with enemies that moved that tick.
+struct LodConfig { int NR = 2000, FR = 4000, MP = 2, FP = 8; };
+// Enemy AI: enemies within LodConfig's NR of a player work out their steering (round robin, a few a tick) for at most BUDGET microseconds
+// a tick, or QUOTA enemies a tick in netplay and headless mode (which must play the same every time). Steering is used for STALE ticks.
+// SEEK/FLOCK/ORBIT/DODGE: how hard each behaviour steers (per tick, relative to the enemy's speed). FR: flocking neighbourhood radius,
+// OR: orbit radius, DR: how close bullets get before enemies dodge them. Chasers (SEEK) don't think: they steer down a flow field with FC sized cells.
+struct AiConfig { int BUDGET = 500, QUOTA = 64, STALE = 30, FR = 150, OR = 300, DR = 250, FC = 64; float SEEK = 0.04f, FLOCK = 0.05f, ORBIT = 0.06f, DODGE = 0.15f; };
+struct NukeConfig { int V = 20, ER = 150, BR = 300, L = 40, REL = 150, FR = 232, FG = 100, FB = 61, OR = 192, OG = 192, OB = 192, CDI = 100; float BVM = 3; };
+
+// Particle effects. KILL/NUKE/TRAIL: particles per enemy kill (a big enemy's worth, smaller ones make fewer), per nuke, per bullet per tick.
+// KS/NS/TS: their speeds (pixels/second), KL/NL/TL: their lifespans (seconds), TV: how much of the bullet's velocity its trail keeps.
+struct ParticleConfig { int KILL = 64, NUKE = 1500, TRAIL = 3; float KS = 350, NS = 1200, TS = 40, KL = 0.7f, NL = 1.2f, TL = 0.3f, TV = 0.15f; };
+
+// The simulation on its own. SEED: random seed, PLAYERS: how many players play (co-op), PLAYER: which of them is the local one.
+// DETERMINISTIC: the AI thinks about AiConfig's QUOTA enemies a tick instead of for its time budget, so a seed always plays out the same.
+// THREADS: threads the simulation may use for itself (building the flow field), 0 is one per core.
+struct SimConfig { unsigned SEED = 1; int PLAYERS = 1, PLAYER = 0, THREADS = 0; bool DETERMINISTIC = true; };
+
+const int MAX_PLAYERS       = 2;
+
+/**
+ * The game's simulation, without a window: entities, systems, and everything else that changes from tick to tick.
+ *
+ * Everything it needs is its own (random numbers included), so any number of them can run side by side, on any
+ * threads (see BatchRunner). Game adds the window, rendering, sound, and netplay on top, and hears about particle
+ * bursts, sound effects, and what each system cost through emitBurst(), emitSound(), and addSystemCost().
+ */
+class GameSim
+{
+public:
+    GameSim(const SimConfig & simConfig = SimConfig(), const WorldConfig & worldConfig = WorldConfig(), const EnemyConfig & enemyConfig = EnemyConfig(), const NukeConfig & nukeConfig = NukeConfig());
+    virtual ~GameSim() = default;
+
+    void simulate(const PlayerInput inputs[MAX_PLAYERS]);
+    PlayerInput botInput(int tick, int nukeTick) const;
+    bool isOver() const;
+    int currentFrame() const;
+    int currentScore();
+    int score();
+    std::uint64_t checksum();
+    int observe(float * x, float * y, float * radius, std::uint8_t * tag, int capacity);
+
+protected:
+    // Everything the simulation changes, so it can be saved and restored (netplay rollback)
+    struct SavedState
+    {
+        EntityManager   entities;
+        Random          random;
+        int             currentFrame                    = 0;
+        int             movementTick                    = 0;
+        Vec2            lodFocus[MAX_PLAYERS];
+        int             lodFocusCount                   = 0;
+        std::uint32_t   aiCursor                        = 0;
+        int             lastEnemySpawnTime              = 0;
+        int             lastNukeTime                    = 0;
+        bool            endGameMenu                     = false;
+        int             highScore                       = 0;
+        int             gameScore                       = 0;
+        bool            isNewHighScore                  = false;
+        int             diffNewHighScorePrevHighScore   = 0;
+        long            playerId                        = -1;
+    };
+
+    // A collision found by sCollision()'s detection pass. a and b are indexes into the entity lists of the
+    // tags the type names (bullet & enemy, player & enemy, nuke & enemy, enemy & enemy).
+    struct Contact
+    {
+        enum Type : std::uint8_t { BULLET_ENEMY, PLAYER_ENEMY, NUKE_EXPLOSION, NUKE_BLAST, ENEMY_ENEMY };
+
+        Type            type;
+        std::uint32_t   a;
+        std::uint32_t   b;
+    };
+
+    EntityManager       m_entities;
+    SimConfig           m_simConfig;
+    PlayerConfig        m_playerConfig;
+    EnemyConfig         m_enemyConfig;
+    BulletConfig        m_bulletConfig;
+    NukeConfig          m_nukeConfig;
+    ParticleConfig      m_particleConfig;
+    WindowConfig        m_windowConfig;
+    LodConfig           m_lodConfig;
+    AiConfig            m_aiConfig;
+    WorldConfig         m_worldConfig;
+    Random              m_random;
+    int                 m_currentFrame          = 0;
+    int                 m_movementTick          = 0;    // sMovement() calls (enemies far away keep what tick they moved to)
+    Vec2                m_lodFocus[MAX_PLAYERS];        // where the players were at the last tick there were any (enemies far from them move less often)
+    int                 m_lodFocusCount         = 0;
+    std::uint32_t       m_aiCursor              = 0;    // enemy (index) the AI works on next
+    int                 m_aiThought             = 0;    // enemies the AI worked on last tick
+    FlowField           m_flowField;                    // to the players, for chasers (worked out from the state, so rollback doesn't save it)
+    int                 m_lastEnemySpawnTime    = 0;
+    int                 m_lastNukeTime          = 0;
+    int                 m_spawnThrottle         = 1;    // enemies spawn this many times less often (Game's governor raises it under load)
+    bool                m_startMenu             = false;
+    bool                m_endGameMenu           = false;
+    int                 m_highScore             = 0;
+    int                 m_gameScore             = 0;
+    bool                m_isNewHighScore        = false;
+    int                 m_diffNewHighScorePrevHighScore = 0;
+    std::uint32_t       m_stateLoads            = 0;    // loadState() calls (entities' versions go back with the state, see Entity::version())
+
+    std::shared_ptr<Entity> m_player;   // the player controlled from this machine (SimConfig's PLAYER)
+
+    // Collision contacts found this tick, and the enemies' positions & radii copied out for detection
+    std::vector<Contact> m_contacts;
+    int                 m_collisionTests        = 0;    // pairs the last detection checked
+    std::uint64_t       m_totalCollisionTests   = 0;    // pairs checked so far (for the performance counters)
+    std::uint64_t       m_totalCollisionHits    = 0;
+    std::vector<Vec2>   m_collisionPos;
+    std::vector<Real>   m_collisionRadius;
+    std::vector<std::uint8_t> m_collisionGhost;         // enemies with lifespans (they don't collide with each other)
+    std::vector<std::uint8_t> m_collisionMoved;         // enemies that moved this tick
+    std::vector<std::uint32_t> m_collisionCandidates;   // enemies near what's being checked, in enemy order
+    SpatialGrid         m_collisionGrid;
+
+    SpawnGrid           m_spawnGrid;
+
+    // Scratch buffers for batched sin/cos (kept around so they don't get reallocated every frame)
+    std::vector<Real>   m_spawnAngles;
+    std::vector<Real>   m_spawnSines;
+    std::vector<Real>   m_spawnCosines;
+
+    virtual void addSystemCost(FrameGovernor::System system, Stopwatch & stopwatch, alloc::Counter & allocs);
+    virtual void emitBurst(const Burst & burst);
+    virtual void emitSound(const SoundEffect & effect);
+
+    void saveState(SavedState & state);
+    void loadState(const SavedState & state);
+    void addScore(int score);
+
+    void sMovement();
+    void moveEnemy(CTransform & transform, float radius, int ticks);
+    void sLifespan();
+    void sEnemySpawner();
+    void sCollision();
+    void reserveCollisions();
+    void detectCollisions();
+    void addContact(const Contact & contact);
+    void onBulletHit(const Contact & contact);
+    void onPlayerHit(const Contact & contact);
+    void onNukeHit(const Contact & contact);
+    void onEnemiesBounce(const Contact & contact);
+    void sAI();
+    void updateFlowField();
+    Vec2 think(std::uint32_t enemy, const CBehaviour & behaviour, const Vec2 & velocity, const Vec2 & target);
+    void sPlayerInput(const PlayerInput inputs[MAX_PLAYERS]);
+
+    void spawnPlayer(int player = 0);
+    void spawnEnemy(int count = 1);
+    void spawnSmallEnemies(std:: shared_ptr<Entity> bigEnemy);
+    void addEnemiesToSpawnGrid();
+    void destroyEnemy(std::shared_ptr<Entity> enemy);
+    void spawnBullet(std::shared_ptr<Entity> player, const Vec2 & mousePos);
+    void spawnSpecialWeapon(std::shared_ptr<Entity> entity);
+    void emitExplosion(std::shared_ptr<Entity> entity);
+};
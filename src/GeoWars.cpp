@@ -0,0 +1,137 @@
+#include "GeoWars.h"
+#include "GameSim.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/**
+ * A game of the C API: a simulation, and its observation's arrays (allocated once, when the game is created).
+ */
+struct geowars
+{
+    WorldConfig                 world;
+    std::unique_ptr<GameSim>    sim;
+    std::vector<float>          x;
+    std::vector<float>          y;
+    std::vector<float>          radius;
+    std::vector<std::uint8_t>   tag;
+    geowars_observation         observation;
+};
+
+namespace
+{
+    /**
+     * Writes the game's observation (into the arrays it already has).
+     */
+    void observe(geowars * game)
+    {
+        geowars_observation & observation = game->observation;
+        observation.count = game->sim->observe(game->x.data(), game->y.data(), game->radius.data(), game->tag.data(), observation.capacity);
+    }
+}
+
+int geowars_api_version(void)
+{
+    return GEOWARS_API_VERSION;
+}
+
+geowars * geowars_create(uint32_t seed, int width, int height, int max_entities)
+{
+    // Nothing may be thrown back into C
+    try
+    {
+        std::unique_ptr<geowars> game(new geowars());
+        game->world.W = width;
+        game->world.H = height;
+
+        const int capacity = std::max(1, max_entities);
+        game->x.resize(capacity);
+        game->y.resize(capacity);
+        game->radius.resize(capacity);
+        game->tag.resize(capacity);
+        game->observation.x = game->x.data();
+        game->observation.y = game->y.data();
+        game->observation.radius = game->radius.data();
+        game->observation.tag = game->tag.data();
+        game->observation.count = 0;
+        game->observation.capacity = capacity;
+
+        return geowars_reset(game.get(), seed) == 0 ? game.release() : nullptr;
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void geowars_destroy(geowars * game)
+{
+    delete game;
+}
+
+int geowars_reset(geowars * game, uint32_t seed)
+{
+    // Deterministic (the same seed and actions always play out the same), and on the caller's thread only
+    SimConfig simConfig;
+    simConfig.SEED = seed;
+    simConfig.THREADS = 1;
+
+    try
+    {
+        game->sim.reset(new GameSim(simConfig, game->world));
+    }
+    catch (...)
+    {
+        return -1;
+    }
+    observe(game);
+    return 0;
+}
+
+int geowars_step(geowars * game, const geowars_action * action)
+{
+    PlayerInput inputs[MAX_PLAYERS];
+    if (action != nullptr)
+    {
+        inputs[0].up = action->up != 0;
+        inputs[0].down = action->down != 0;
+        inputs[0].left = action->left != 0;
+        inputs[0].right = action->right != 0;
+        inputs[0].shoot = action->shoot != 0;
+        inputs[0].aimX = action->aim_x;
+        inputs[0].aimY = action->aim_y;
+        inputs[0].nuke = action->nuke != 0;
+    }
+
+    try
+    {
+        game->sim->simulate(inputs);
+    }
+    catch (...)
+    {
+        return -1;
+    }
+    observe(game);
+    return geowars_done(game);
+}
+
+int geowars_score(geowars * game)
+{
+    return game->sim->score();
+}
+
+int geowars_done(const geowars * game)
+{
+    return game->sim->isOver() ? 1 : 0;
+}
+
+int geowars_tick(const geowars * game)
+{
+    return game->sim->currentFrame();
+}
+
+const geowars_observation * geowars_observe(const geowars * game)
+{
+    return &game->observation;
+}
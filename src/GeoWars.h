@@ -0,0 +1,98 @@
+#pragma once
+
+/**
+ * C API of the game's simulation (libgeowars.so), for driving games from other programs: bot trainers, replay
+ * analysers, test harnesses. It's plain C, so it can be used from C, or from anything that can call C (Python's
+ * ctypes, ...).
+ *
+ * A game is one simulation (no window, no rendering, no sound), played one tick per geowars_step() by one player,
+ * who does whatever the action says. The same seed and actions always play out the same.
+ *
+ * What's in the game is in its observation: contiguous arrays of every entity's position, radius and tag, owned by
+ * the game. They're written in place by every step and reset, and never move, so they can be read (or wrapped, e.g.
+ * by numpy) once and looked at after every step without copying them.
+ *
+ * Functions can be called from any thread, but one game only from one thread at a time. Games don't share anything,
+ * so different games can be stepped on different threads at once.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GEOWARS_API_VERSION 1   /* changes when something in this file changes in a way that breaks callers */
+
+#if defined(__GNUC__)
+#define GEOWARS_API __attribute__((visibility("default")))
+#else
+#define GEOWARS_API
+#endif
+
+/* Entity tags in the observation */
+enum { GEOWARS_PLAYER = 0, GEOWARS_ENEMY = 1, GEOWARS_BULLET = 2, GEOWARS_NUKE = 3 };
+
+typedef struct geowars geowars;
+
+/* What the player does on a tick. Movement is held for as long as it's set, shoot and nuke happen on the tick they're set. */
+typedef struct geowars_action
+{
+    int     up;
+    int     down;
+    int     left;
+    int     right;
+    int     shoot;      /* fires a bullet at (aim_x, aim_y) */
+    float   aim_x;      /* world coordinates */
+    float   aim_y;
+    int     nuke;       /* only if the nuke has cooled down */
+} geowars_action;
+
+/* Every entity in the game: players first, then enemies, bullets, and nukes. Entities past capacity are left out. */
+typedef struct geowars_observation
+{
+    const float *   x;          /* centre, world coordinates */
+    const float *   y;
+    const float *   radius;     /* collision radius (a nuke's is its explosion's) */
+    const uint8_t * tag;        /* GEOWARS_PLAYER, ... */
+    int             count;      /* entities in the arrays */
+    int             capacity;   /* size of the arrays */
+} geowars_observation;
+
+/* Returns GEOWARS_API_VERSION as the library was built (to check it's the one the caller was built against). */
+GEOWARS_API int geowars_api_version(void);
+
+/*
+ * Creates a game. Returns NULL if it can't.
+ *
+ * seed         - random seed
+ * width        - size of the world (0, or less than the window's size, is the window's: 1280x720)
+ * height
+ * max_entities - capacity of the observation's arrays
+ */
+GEOWARS_API geowars * geowars_create(uint32_t seed, int width, int height, int max_entities);
+GEOWARS_API void geowars_destroy(geowars * game);
+
+/*
+ * Starts the game again from the beginning, with another seed (the observation's arrays stay where they are). Returns
+ * 0, or -1 if it can't (out of memory), and the game is left as it was.
+ */
+GEOWARS_API int geowars_reset(geowars * game, uint32_t seed);
+
+/* Simulates one tick, with the player doing what the action says (NULL does nothing). Returns geowars_done(), or -1 if it can't (out of memory). */
+GEOWARS_API int geowars_step(geowars * game, const geowars_action * action);
+
+GEOWARS_API int geowars_score(geowars * game);      /* the player's score (the final one once the game is over) */
+GEOWARS_API int geowars_done(const geowars * game); /* 1 once the player is dead, 0 before */
+GEOWARS_API int geowars_tick(const geowars * game); /* ticks played (it stops counting once the game is over) */
+
+/*
+ * The game's observation, as of the last step or reset. The pointer stays the same for the game's lifetime. Entities
+ * join the game at the start of the tick after they're spawned, so it's empty after create and reset, until the
+ * first step.
+ */
+GEOWARS_API const geowars_observation * geowars_observe(const geowars * game);
+
+#ifdef __cplusplus
+}
+#endif
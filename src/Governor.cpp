@@ -0,0 +1,141 @@
+#include "Governor.h"
+
+#include <algorithm>
+
+/**
+ * Creates a governor at full quality.
+ */
+FrameGovernor::FrameGovernor(const GovernorConfig & config)
+    : m_config(config)
+{
+}
+
+/**
+ * Sets the budgets.
+ * 
+ * tickMs  - milliseconds the simulation has per tick
+ * frameMs - milliseconds the render thread has per frame
+ */
+void FrameGovernor::setBudget(double tickMs, double frameMs)
+{
+    m_tickBudget = tickMs;
+    m_frameBudget = frameMs;
+}
+
+/**
+ * Adds to what a system cost this tick (a system can run more than once per tick, e.g. netplay rollback).
+ * 
+ * system - the system
+ * ms     - milliseconds it took
+ */
+void FrameGovernor::addCost(System system, double ms)
+{
+    m_tickCosts[system] += ms;
+}
+
+/**
+ * Ends the tick: updates the smoothed costs and steps the quality level up or down if needed.
+ */
+void FrameGovernor::endTick()
+{
+    double simulation = 0;
+    for (int i = 0; i < SYSTEM_COUNT; i++)
+    {
+        m_costs[i] += (m_tickCosts[i] - m_costs[i]) * m_config.SMOOTHING;
+        m_tickCosts[i] = 0;
+
+        if (i != RENDER)
+        {
+            simulation += m_costs[i];
+        }
+    }
+
+    // The simulation and the render thread run side by side, so whichever is closest to its budget is the one that matters
+    m_pressure = std::max(simulation / m_tickBudget, m_costs[RENDER] / m_frameBudget);
+
+    m_overTicks = m_pressure > m_config.HIGH ? m_overTicks + 1 : 0;
+    m_underTicks = m_pressure < m_config.LOW ? m_underTicks + 1 : 0;
+
+    if (m_overTicks >= m_config.DOWN && m_level + 1 < LEVEL_COUNT)
+    {
+        m_level = (Level) (m_level + 1);
+        m_overTicks = 0;
+    }
+    else if (m_underTicks >= m_config.UP && m_level > FULL)
+    {
+        m_level = (Level) (m_level - 1);
+        m_underTicks = 0;
+    }
+
+    m_ticksAt[m_level]++;
+}
+
+/**
+ * Returns the current quality level.
+ */
+FrameGovernor::Level FrameGovernor::level() const
+{
+    return m_level;
+}
+
+/**
+ * Returns what a system costs per tick (smoothed, in milliseconds).
+ */
+double FrameGovernor::cost(System system) const
+{
+    return m_costs[system];
+}
+
+/**
+ * Returns what a system has cost so far this tick (in milliseconds, reset by endTick()).
+ */
+double FrameGovernor::tickCost(System system) const
+{
+    return m_tickCosts[system];
+}
+
+/**
+ * Returns how much of the budget is used (1 is all of it).
+ */
+double FrameGovernor::pressure() const
+{
+    return m_pressure;
+}
+
+/**
+ * Returns how many ticks were spent at a quality level.
+ */
+long FrameGovernor::ticksAt(Level level) const
+{
+    return m_ticksAt[level];
+}
+
+const char * FrameGovernor::levelName(Level level)
+{
+    switch (level)
+    {
+        case FULL:              return "full";
+        case REDUCED_SHAPES:    return "reduced shapes";
+        case NO_OUTLINES:       return "no outlines";
+        case SLOW_HUD:          return "slow HUD";
+        case THROTTLE_SPAWNER:  return "throttled spawner";
+        default:                return "?";
+    }
+}
+
+const char * FrameGovernor::systemName(System system)
+{
+    switch (system)
+    {
+        case INPUT:     return "input";
+        case UPDATE:    return "update";
+        case SPAWNER:   return "spawner";
+        case MOVEMENT:  return "movement";
+        case COLLISION: return "collision";
+        case AI:        return "ai";
+        case LIFESPAN:  return "lifespan";
+        case SNAPSHOT:  return "snapshot";
+        case RENDER:    return "render";
+        default:        return "?";
+    }
+}
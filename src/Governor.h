@@ -0,0 +1,48 @@
+#pragma once
+
+// HIGH/LOW: step quality down when over HIGH of the budget, back up when under LOW of it (as fractions of the budget).
+// DOWN/UP: for how many ticks in a row (stepping up takes longer, so the level doesn't flip back and forth).
+// HUD: at SLOW_HUD, the HUD is only updated every HUD frames. SPAWN: at THROTTLE_SPAWNER, enemies spawn SPAWN times less often.
+struct GovernorConfig { float HIGH = 0.9f, LOW = 0.6f, SMOOTHING = 0.1f; int DOWN = 15, UP = 120, HUD = 10, SPAWN = 2; };
+
+/**
+ * Frame budget governor.
+ * 
+ * Tracks how much of the frame budget each system costs, and when the game gets too expensive (e.g. lots of enemies
+ * after chain splits) steps quality down one level at a time until it fits in the budget again. Each level includes
+ * the ones before it. Quality is stepped back up once there is room to spare for a while.
+ */
+class FrameGovernor
+{
+public:
+    enum Level { FULL, REDUCED_SHAPES, NO_OUTLINES, SLOW_HUD, THROTTLE_SPAWNER, LEVEL_COUNT };
+    enum System { INPUT, UPDATE, SPAWNER, MOVEMENT, COLLISION, AI, LIFESPAN, SNAPSHOT, RENDER, SYSTEM_COUNT };
+
+    FrameGovernor(const GovernorConfig & config = GovernorConfig());
+
+    void setBudget(double tickMs, double frameMs);
+    void addCost(System system, double ms);
+    void endTick();
+
+    Level level() const;
+    double cost(System system) const;
+    double tickCost(System system) const;
+    double pressure() const;
+    long ticksAt(Level level) const;
+
+    static const char * levelName(Level level);
+    static const char * systemName(System system);
+
+private:
+    GovernorConfig  m_config;
+    double          m_tickBudget    = 1000.0 / 60;  // ms the simulation has per tick
+    double          m_frameBudget   = 1000.0 / 60;  // ms the render thread has per frame
+    double          m_tickCosts[SYSTEM_COUNT]   = {};   // this tick
+    double          m_costs[SYSTEM_COUNT]       = {};   // smoothed
+    double          m_pressure      = 0;
+    int             m_overTicks     = 0;
+    int             m_underTicks    = 0;
+    Level           m_level         = FULL;
+    long            m_ticksAt[LEVEL_COUNT]      = {};
+};
+
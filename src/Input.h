@@ -0,0 +1,42 @@
+#pragma once
+
+#include <SFML/Window/Event.hpp>
+#include <chrono>
+
+/**
+ * What a player did during one simulation tick.
+ * 
+ * Movement keys are held (they stay set for as long as the key is down), shoot and nuke are one-off
+ * actions (set only on the tick they happened). This is what is sent over the network in netplay.
+ */
+struct PlayerInput
+{
+    bool  up    = false;
+    bool  left  = false;
+    bool  down  = false;
+    bool  right = false;
+    bool  shoot = false;
+    bool  nuke  = false;
+    float aimX  = 0;    // where to shoot at (world coordinates)
+    float aimY  = 0;
+
+    bool operator == (const PlayerInput & rhs) const
+    {
+        return up == rhs.up && left == rhs.left && down == rhs.down && right == rhs.right
+            && shoot == rhs.shoot && nuke == rhs.nuke && aimX == rhs.aimX && aimY == rhs.aimY;
+    }
+
+    bool operator != (const PlayerInput & rhs) const
+    {
+        return !(*this == rhs);
+    }
+};
+
+/**
+ * A window event, with when it was taken from the window (so input latency can be measured).
+ */
+struct TimedEvent
+{
+    sf::Event                               event;
+    std::chrono::steady_clock::time_point   time;
+};
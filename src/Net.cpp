@@ -0,0 +1,188 @@
+#include "Net.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    const std::uint32_t PACKET_MAGIC    = 0x47574e31; // "GWN1"
+    const std::size_t   HEADER_SIZE     = 4 + 4 + 4 + 2;
+    const std::size_t   INPUT_SIZE      = 1 + 4 + 4;
+    const std::size_t   MAX_PACKET_SIZE = 1024;
+
+    double nowMs()
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    template <typename T>
+    void write(std::vector<std::uint8_t> & bytes, T value)
+    {
+        const std::size_t at = bytes.size();
+        bytes.resize(at + sizeof(T));
+        std::memcpy(&bytes[at], &value, sizeof(T));
+    }
+
+    template <typename T>
+    T read(const std::uint8_t * bytes, std::size_t & at)
+    {
+        T value;
+        std::memcpy(&value, bytes + at, sizeof(T));
+        at += sizeof(T);
+        return value;
+    }
+}
+
+NetPeer::~NetPeer()
+{
+    if (m_socket >= 0)
+    {
+        close(m_socket);
+    }
+}
+
+/**
+ * Opens the connection.
+ * 
+ * Returns false if the local port could not be used.
+ * 
+ * localPort   - port this game receives on
+ * remotePort  - port the other game receives on
+ * delayMs     - outgoing packets are held back this long
+ * lossPercent - chance (0 to 100) that an outgoing packet is dropped
+ */
+bool NetPeer::open(std::uint16_t localPort, std::uint16_t remotePort, int delayMs, int lossPercent)
+{
+    m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_socket < 0)
+    {
+        return false;
+    }
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(localPort);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(m_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        return false;
+    }
+
+    // Never block the game waiting for packets
+    fcntl(m_socket, F_SETFL, fcntl(m_socket, F_GETFL, 0) | O_NONBLOCK);
+
+    m_remotePort = remotePort;
+    m_delayMs = delayMs;
+    m_lossPercent = lossPercent;
+    m_shimRandom.seed(localPort);
+
+    return true;
+}
+
+/**
+ * Queues a packet to be sent (it is sent right away unless the shim delays or drops it).
+ */
+void NetPeer::send(const InputPacket & packet)
+{
+    if (m_lossPercent > 0 && static_cast<int>(m_shimRandom() % 100) < m_lossPercent)
+    {
+        return;
+    }
+
+    Pending pending;
+    pending.sendTime = nowMs() + m_delayMs;
+    pending.bytes.reserve(HEADER_SIZE + INPUT_SIZE * packet.inputs.size());
+
+    write<std::uint32_t>(pending.bytes, PACKET_MAGIC);
+    write<std::uint32_t>(pending.bytes, packet.firstTick);
+    write<std::int32_t>(pending.bytes, packet.ackTick);
+    write<std::uint16_t>(pending.bytes, static_cast<std::uint16_t>(packet.inputs.size()));
+
+    for (const PlayerInput & input : packet.inputs)
+    {
+        const std::uint8_t flags = input.up << 0 | input.left << 1 | input.down << 2 | input.right << 3 | input.shoot << 4 | input.nuke << 5;
+        write<std::uint8_t>(pending.bytes, flags);
+        write<float>(pending.bytes, input.aimX);
+        write<float>(pending.bytes, input.aimY);
+    }
+
+    m_pending.push_back(pending);
+    update();
+}
+
+/**
+ * Sends the queued packets that are due.
+ */
+void NetPeer::update()
+{
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(m_remotePort);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    const double now = nowMs();
+    while (!m_pending.empty() && m_pending.front().sendTime <= now)
+    {
+        const std::vector<std::uint8_t> & bytes = m_pending.front().bytes;
+        sendto(m_socket, bytes.data(), bytes.size(), 0, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+        m_pending.pop_front();
+    }
+}
+
+/**
+ * Gets the next received packet.
+ * 
+ * Returns false if there are no more packets (malformed packets are skipped).
+ */
+bool NetPeer::receive(InputPacket & packet)
+{
+    std::uint8_t bytes[MAX_PACKET_SIZE];
+
+    while (true)
+    {
+        const ssize_t size = recv(m_socket, bytes, sizeof(bytes), 0);
+        if (size < 0)
+        {
+            return false;
+        }
+
+        std::size_t at = 0;
+        if (static_cast<std::size_t>(size) < HEADER_SIZE || read<std::uint32_t>(bytes, at) != PACKET_MAGIC)
+        {
+            continue;
+        }
+
+        packet.firstTick = read<std::uint32_t>(bytes, at);
+        packet.ackTick = read<std::int32_t>(bytes, at);
+        const std::uint16_t count = read<std::uint16_t>(bytes, at);
+        if (static_cast<std::size_t>(size) != HEADER_SIZE + INPUT_SIZE * count)
+        {
+            continue;
+        }
+
+        packet.inputs.resize(count);
+        for (PlayerInput & input : packet.inputs)
+        {
+            const std::uint8_t flags = read<std::uint8_t>(bytes, at);
+            input.up    = flags & (1 << 0);
+            input.left  = flags & (1 << 1);
+            input.down  = flags & (1 << 2);
+            input.right = flags & (1 << 3);
+            input.shoot = flags & (1 << 4);
+            input.nuke  = flags & (1 << 5);
+            input.aimX  = read<float>(bytes, at);
+            input.aimY  = read<float>(bytes, at);
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+#include "Input.h"
+
+/**
+ * Packet sent between the two games in netplay.
+ * 
+ * Carries the sender's inputs for ticks [firstTick, firstTick + inputs.size()), and the last tick of the
+ * receiver's inputs the sender has (so the receiver knows what it no longer needs to resend).
+ */
+struct InputPacket
+{
+    std::uint32_t            firstTick  = 0;
+    std::int32_t             ackTick    = -1;
+    std::vector<PlayerInput> inputs;
+};
+
+/**
+ * UDP connection to another game running on this machine (127.0.0.1).
+ * 
+ * Outgoing packets go through a shim that can delay and drop them, to try netplay on a bad network
+ * without needing one.
+ */
+class NetPeer
+{
+public:
+    NetPeer() {}
+    ~NetPeer();
+
+    bool open(std::uint16_t localPort, std::uint16_t remotePort, int delayMs, int lossPercent);
+    void send(const InputPacket & packet);
+    bool receive(InputPacket & packet);
+    void update();
+
+private:
+    struct Pending
+    {
+        double                    sendTime;
+        std::vector<std::uint8_t> bytes;
+    };
+
+    int                 m_socket        = -1;
+    std::uint16_t       m_remotePort    = 0;
+    int                 m_delayMs       = 0;
+    int                 m_lossPercent   = 0;
+    std::deque<Pending> m_pending;
+    std::minstd_rand    m_shimRandom;
+
+    NetPeer(const NetPeer &) = delete;
+    NetPeer & operator = (const NetPeer &) = delete;
+};
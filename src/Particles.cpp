@@ -0,0 +1,150 @@
+#include "Particles.h"
+#include "FastMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    const float DRAG        = 0.05f;    // fraction of its speed a particle keeps after 1 second
+    const float STREAK      = 0.03f;    // a particle is drawn as a line as long as the distance it moves in this many seconds
+}
+
+/**
+ * Creates a particle system with room for a fixed number of particles.
+ * 
+ * capacity - most particles alive at once (rounded up to a multiple of 4)
+ */
+ParticleSystem::ParticleSystem(size_t capacity)
+{
+    capacity = (capacity + 3) / 4 * 4;
+
+    m_x.resize(capacity);
+    m_y.resize(capacity);
+    m_vx.resize(capacity);
+    m_vy.resize(capacity);
+    m_life.resize(capacity, 0);
+    m_invLife.resize(capacity, 0);
+    m_color.resize(capacity);
+}
+
+/**
+ * Spawns a burst of particles.
+ */
+void ParticleSystem::spawn(const Burst & burst)
+{
+    const size_t capacity = m_x.size();
+    if (capacity == 0 || burst.life <= 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < burst.count; i++)
+    {
+        // Random direction, and a random speed biased towards the top speed (so bursts look like rings)
+        float s, c;
+        fastmath::sincosDeg((float) m_random.fromRange(0, 359), s, c);
+        const float speed = burst.speed * (0.25f + 0.75f * std::sqrt(m_random.fromRange(0, 1000) / 1000.0f));
+
+        const size_t p = m_next;
+        m_x[p] = burst.x;
+        m_y[p] = burst.y;
+        m_vx[p] = burst.vx + c * speed;
+        m_vy[p] = burst.vy + s * speed;
+        m_life[p] = burst.life;
+        m_invLife[p] = 1 / burst.life;
+        m_color[p] = burst.color;
+
+        m_next = (m_next + 1) % capacity;
+        m_used = std::max(m_used, p + 1);
+    }
+}
+
+/**
+ * Moves particles and ages them.
+ * 
+ * dt - seconds since the last update
+ */
+void ParticleSystem::update(float dt)
+{
+    const float drag = std::pow(DRAG, dt);
+    const size_t count = (m_used + 3) / 4 * 4;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128 dt4 = _mm_set1_ps(dt);
+    const __m128 drag4 = _mm_set1_ps(drag);
+    for (; i < count; i += 4)
+    {
+        __m128 vx = _mm_loadu_ps(&m_vx[i]);
+        __m128 vy = _mm_loadu_ps(&m_vy[i]);
+        _mm_storeu_ps(&m_x[i], _mm_add_ps(_mm_loadu_ps(&m_x[i]), _mm_mul_ps(vx, dt4)));
+        _mm_storeu_ps(&m_y[i], _mm_add_ps(_mm_loadu_ps(&m_y[i]), _mm_mul_ps(vy, dt4)));
+        _mm_storeu_ps(&m_vx[i], _mm_mul_ps(vx, drag4));
+        _mm_storeu_ps(&m_vy[i], _mm_mul_ps(vy, drag4));
+        _mm_storeu_ps(&m_life[i], _mm_sub_ps(_mm_loadu_ps(&m_life[i]), dt4));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        m_x[i] += m_vx[i] * dt;
+        m_y[i] += m_vy[i] * dt;
+        m_vx[i] *= drag;
+        m_vy[i] *= drag;
+        m_life[i] -= dt;
+    }
+}
+
+/**
+ * Adds a line (2 vertices, for drawing with sf::Lines) for each live particle. Particles fade out as they age.
+ * 
+ * vertices - where to add them
+ */
+void ParticleSystem::appendVertices(std::vector<sf::Vertex> & vertices)
+{
+    // Room for every particle, then trimmed to the live ones (cheaper than growing it one vertex at a time)
+    const size_t start = vertices.size();
+    vertices.resize(start + m_used * 2);
+    sf::Vertex * out = vertices.data() + start;
+
+    for (size_t i = 0; i < m_used; i++)
+    {
+        if (m_life[i] <= 0)
+        {
+            continue;
+        }
+
+        sf::Color color = m_color[i];
+        color.a = (sf::Uint8) (color.a * std::min(1.0f, m_life[i] * m_invLife[i]));
+
+        out[0].position = sf::Vector2f(m_x[i], m_y[i]);
+        out[0].color = color;
+        out[1].position = sf::Vector2f(m_x[i] - m_vx[i] * STREAK, m_y[i] - m_vy[i] * STREAK);
+        out[1].color = color;
+        out += 2;
+    }
+
+    m_live = (out - (vertices.data() + start)) / 2;
+    vertices.resize(start + m_live * 2);
+}
+
+/**
+ * Returns the most particles that can be alive at once.
+ */
+size_t ParticleSystem::capacity() const
+{
+    return m_x.size();
+}
+
+/**
+ * Returns how many particles were alive the last time vertices were made.
+ */
+size_t ParticleSystem::liveCount() const
+{
+    return m_live;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+#include "Random.h"
+
+/**
+ * A burst of particles (e.g. an enemy exploding). Particles fly out in random directions from (x, y).
+ */
+struct Burst
+{
+    float       x       = 0;
+    float       y       = 0;
+    float       vx      = 0;    // velocity all particles get on top of their own (pixels/second), e.g. a bullet trail
+    float       vy      = 0;
+    float       speed   = 0;    // most speed a particle gets away from (x, y) (pixels/second)
+    float       life    = 0;    // seconds
+    int         count   = 0;
+    sf::Color   color;
+};
+
+/**
+ * Particles for effects (explosions, trails). They don't interact with anything, so they only live on the render thread.
+ * 
+ * Stored as structure of arrays so update() works on 4 particles at a time (SSE). Storage is a fixed-size ring: new
+ * particles take the oldest slots, so spawning never allocates, and when full the oldest particles are the ones that go.
+ */
+class ParticleSystem
+{
+public:
+    ParticleSystem(size_t capacity);
+
+    void spawn(const Burst & burst);
+    void update(float dt);
+    void appendVertices(std::vector<sf::Vertex> & vertices);
+
+    size_t capacity() const;
+    size_t liveCount() const;
+
+private:
+    std::vector<float>          m_x;
+    std::vector<float>          m_y;
+    std::vector<float>          m_vx;
+    std::vector<float>          m_vy;
+    std::vector<float>          m_life;     // seconds left (dead when <= 0)
+    std::vector<float>          m_invLife;  // 1 / total seconds (for fading)
+    std::vector<sf::Color>      m_color;
+    size_t                      m_next      = 0;    // ring position of the next particle
+    size_t                      m_used      = 0;    // slots that were ever used (the rest are skipped)
+    size_t                      m_live      = 0;    // counted by appendVertices()
+    Random                      m_random;
+};
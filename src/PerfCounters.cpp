@@ -0,0 +1,183 @@
+#include "PerfCounters.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+PerfWriter::~PerfWriter()
+{
+    close();
+}
+
+/**
+ * Creates the shared memory segment (or takes over one left behind by a game that didn't exit cleanly).
+ * 
+ * name - shared memory name (starts with a '/')
+ * 
+ * Returns false if it couldn't be created, the game runs fine without it.
+ */
+bool PerfWriter::open(const std::string & name)
+{
+    close();
+
+    const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        std::cout << "Error with creating performance counters " << name << ".\n";
+        return false;
+    }
+
+    void * memory = MAP_FAILED;
+    if (ftruncate(fd, sizeof(PerfSegment)) == 0)
+    {
+        memory = mmap(nullptr, sizeof(PerfSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        std::cout << "Error with mapping performance counters " << name << ".\n";
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // Readers check the magic last, so they don't look at a half set up segment
+    m_segment = static_cast<PerfSegment *>(memory);
+    m_segment->magic = 0;
+    std::memset(static_cast<void *>(m_segment->slots), 0, sizeof(m_segment->slots));
+    m_segment->version = PERF_VERSION;
+    m_segment->capacity = PERF_RING_SIZE;
+    m_segment->frameSize = sizeof(PerfFrame);
+    m_segment->written.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_segment->magic = PERF_MAGIC;
+
+    m_name = name;
+    return true;
+}
+
+/**
+ * Unmaps and removes the segment (readers that have it open keep their copy of the mapping).
+ */
+void PerfWriter::close()
+{
+    if (m_segment != nullptr)
+    {
+        munmap(m_segment, sizeof(PerfSegment));
+        shm_unlink(m_name.c_str());
+        m_segment = nullptr;
+    }
+}
+
+bool PerfWriter::isOpen() const
+{
+    return m_segment != nullptr;
+}
+
+/**
+ * Publishes a frame (overwriting the oldest one once the ring is full).
+ */
+void PerfWriter::publish(const PerfFrame & frame)
+{
+    if (m_segment == nullptr)
+    {
+        return;
+    }
+
+    const std::uint64_t index = m_segment->written.load(std::memory_order_relaxed);
+    PerfSegment::Slot & slot = m_segment->slots[index % PERF_RING_SIZE];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.frame = frame;
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    m_segment->written.store(index + 1, std::memory_order_release);
+}
+
+PerfReader::~PerfReader()
+{
+    close();
+}
+
+/**
+ * Opens a game's segment.
+ * 
+ * name - shared memory name (starts with a '/')
+ * 
+ * Returns false if there is no game running with that name, or it's from a different version of the game.
+ */
+bool PerfReader::open(const std::string & name)
+{
+    close();
+
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    void * memory = mmap(nullptr, sizeof(PerfSegment), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_segment = static_cast<const PerfSegment *>(memory);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_segment->magic != PERF_MAGIC || m_segment->version != PERF_VERSION || m_segment->frameSize != sizeof(PerfFrame))
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void PerfReader::close()
+{
+    if (m_segment != nullptr)
+    {
+        munmap(const_cast<PerfSegment *>(m_segment), sizeof(PerfSegment));
+        m_segment = nullptr;
+    }
+}
+
+/**
+ * Returns how many frames have been published so far (the newest one is written() - 1).
+ */
+std::uint64_t PerfReader::written() const
+{
+    return m_segment != nullptr ? m_segment->written.load(std::memory_order_acquire) : 0;
+}
+
+/**
+ * Copies out a frame.
+ * 
+ * index - which frame (0 is the first one published)
+ * frame - set to the frame
+ * 
+ * Returns false if the frame isn't there (not published yet, or already overwritten, or being overwritten right now).
+ */
+bool PerfReader::read(std::uint64_t index, PerfFrame & frame) const
+{
+    if (m_segment == nullptr)
+    {
+        return false;
+    }
+
+    const PerfSegment::Slot & slot = m_segment->slots[index % PERF_RING_SIZE];
+
+    const std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before != 2 * index + 2)
+    {
+        return false;
+    }
+
+    std::memcpy(static_cast<void *>(&frame), &slot.frame, sizeof(PerfFrame));
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return slot.sequence.load(std::memory_order_relaxed) == before;
+}
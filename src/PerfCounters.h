@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "Governor.h"
+
+const char * const  PERF_SEGMENT        = "/geowars-perf";  // shared memory name (it shows up as /dev/shm/geowars-perf)
+const std::uint32_t PERF_MAGIC          = 0x47575043;       // "GWPC"
+const std::uint32_t PERF_VERSION        = 3;
+const std::uint32_t PERF_RING_SIZE      = 1024;             // ticks kept (a reader has to keep up with this many)
+
+enum PerfTag { PERF_PLAYER, PERF_ENEMY, PERF_BULLET, PERF_NUKE, PERF_TAG_COUNT };
+
+/**
+ * Counters for one simulation tick. Plain fixed size fields only, it's read by other processes.
+ */
+struct PerfFrame
+{
+    std::uint64_t   tick                = 0;
+    float           tickMs              = 0;    // the tick's systems added up
+    float           frameMs             = 0;    // render thread's latest frame
+    float           systemMs[FrameGovernor::SYSTEM_COUNT] = {};
+    std::uint32_t   entities[PERF_TAG_COUNT] = {};
+    std::uint32_t   spawns              = 0;    // entities added
+    std::uint32_t   destroys            = 0;    // entities removed
+    std::uint32_t   collisionTests      = 0;    // pairs checked
+    std::uint32_t   collisionHits       = 0;    // pairs that were touching
+    std::uint32_t   allocations         = 0;    // whole process, since the last tick
+    std::uint32_t   systemAllocations[FrameGovernor::SYSTEM_COUNT] = {};  // by each system this tick (render: its latest frame)
+    std::uint64_t   allocatedBytes      = 0;
+};
+
+/**
+ * Layout of the shared memory segment: a ring of the latest frames with one writer (the game) and any number of readers.
+ *
+ * Each slot has a sequence number, odd while the writer is in the middle of it and 2 * (frame index + 1) once it's
+ * written, so a reader can tell it got a whole frame by checking the sequence is the same before and after copying.
+ * Nobody ever waits on anybody: a reader that falls behind just misses frames.
+ */
+struct PerfSegment
+{
+    struct Slot
+    {
+        std::atomic<std::uint64_t>  sequence;
+        PerfFrame                   frame;
+    };
+
+    std::uint32_t                   magic;
+    std::uint32_t                   version;
+    std::uint32_t                   capacity;
+    std::uint32_t                   frameSize;
+    std::atomic<std::uint64_t>      written;    // frames published so far
+    Slot                            slots[PERF_RING_SIZE];
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared memory counters need lock-free 64 bit atomics");
+
+/**
+ * The game's side: creates the segment and publishes a frame per tick.
+ */
+class PerfWriter
+{
+public:
+    ~PerfWriter();
+
+    bool open(const std::string & name = PERF_SEGMENT);
+    void close();
+    bool isOpen() const;
+    void publish(const PerfFrame & frame);
+
+private:
+    std::string     m_name;
+    PerfSegment *   m_segment   = nullptr;
+};
+
+/**
+ * A monitor's side: opens the segment read only and copies frames out of it.
+ */
+class PerfReader
+{
+public:
+    ~PerfReader();
+
+    bool open(const std::string & name = PERF_SEGMENT);
+    void close();
+    std::uint64_t written() const;
+    bool read(std::uint64_t index, PerfFrame & frame) const;
+
+private:
+    const PerfSegment * m_segment = nullptr;
+};
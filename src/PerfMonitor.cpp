@@ -0,0 +1,210 @@
+#include "PerfCounters.h"
+#include "Stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+/**
+ * Watches a running game's performance counters (see PerfCounters.h).
+ * 
+ * Usage:
+ *   PerfMonitor.exe [--name <segment>] [--csv <file>] [--window <ticks>]
+ * 
+ * Every second prints p50/p95/p99 of the tick, frame and system times over the latest window of ticks (600 by
+ * default), and the latest counts. With --csv every tick read is also written to the file, one row per tick.
+ * Stops once the game has stopped publishing for a few seconds.
+ */
+
+static const char * const TAG_NAMES[PERF_TAG_COUNT] = { "players", "enemies", "bullets", "nukes" };
+
+static void writeCsvHeader(std::ostream & out)
+{
+    out << "tick,tick_ms,frame_ms";
+    for (int system = 0; system < FrameGovernor::SYSTEM_COUNT; system++)
+    {
+        out << "," << FrameGovernor::systemName((FrameGovernor::System) system) << "_ms";
+    }
+    for (int tag = 0; tag < PERF_TAG_COUNT; tag++)
+    {
+        out << "," << TAG_NAMES[tag];
+    }
+    out << ",spawns,destroys,collision_tests,collision_hits,allocations,allocated_bytes";
+    for (int system = 0; system < FrameGovernor::SYSTEM_COUNT; system++)
+    {
+        out << "," << FrameGovernor::systemName((FrameGovernor::System) system) << "_allocations";
+    }
+    out << "\n";
+}
+
+static void writeCsvRow(std::ostream & out, const PerfFrame & frame)
+{
+    out << frame.tick << "," << frame.tickMs << "," << frame.frameMs;
+    for (int system = 0; system < FrameGovernor::SYSTEM_COUNT; system++)
+    {
+        out << "," << frame.systemMs[system];
+    }
+    for (int tag = 0; tag < PERF_TAG_COUNT; tag++)
+    {
+        out << "," << frame.entities[tag];
+    }
+    out << "," << frame.spawns << "," << frame.destroys << "," << frame.collisionTests << "," << frame.collisionHits
+        << "," << frame.allocations << "," << frame.allocatedBytes;
+    for (int system = 0; system < FrameGovernor::SYSTEM_COUNT; system++)
+    {
+        out << "," << frame.systemAllocations[system];
+    }
+    out << "\n";
+}
+
+static void printWindow(const std::deque<PerfFrame> & window, std::uint64_t missed)
+{
+    Distribution tick, frame, systems[FrameGovernor::SYSTEM_COUNT];
+    std::uint64_t spawns = 0, destroys = 0, tests = 0, hits = 0, allocations = 0;
+    std::uint64_t systemAllocations[FrameGovernor::SYSTEM_COUNT] = {};
+
+    for (const PerfFrame & f : window)
+    {
+        tick.add(f.tickMs);
+        frame.add(f.frameMs);
+        for (int system = 0; system < FrameGovernor::SYSTEM_COUNT; system++)
+        {
+            systems[system].add(f.systemMs[system]);
+            systemAllocations[system] += f.systemAllocations[system];
+        }
+        spawns += f.spawns;
+        destroys += f.destroys;
+        tests += f.collisionTests;
+        hits += f.collisionHits;
+        allocations += f.allocations;
+    }
+
+    const PerfFrame & latest = window.back();
+    const double ticks = (double) window.size();
+
+    std::cout << "\ntick " << latest.tick << " (last " << window.size() << " ticks, " << missed << " missed)\n";
+    tick.print(std::cout, "tick (ms)");
+    frame.print(std::cout, "frame (ms)");
+    for (int system = 0; system < FrameGovernor::SYSTEM_COUNT; system++)
+    {
+        systems[system].print(std::cout, std::string("  ") + FrameGovernor::systemName((FrameGovernor::System) system));
+    }
+
+    std::cout << "entities:";
+    for (int tag = 0; tag < PERF_TAG_COUNT; tag++)
+    {
+        std::cout << " " << TAG_NAMES[tag] << "=" << latest.entities[tag];
+    }
+    std::cout << "\nper tick: spawns=" << spawns / ticks << " destroys=" << destroys / ticks
+              << " collision tests=" << tests / ticks << " hits=" << hits / ticks
+              << " allocations=" << allocations / ticks << "\n";
+    std::cout << "allocations per tick:";
+    for (int system = 0; system < FrameGovernor::SYSTEM_COUNT; system++)
+    {
+        std::cout << " " << FrameGovernor::systemName((FrameGovernor::System) system) << "=" << systemAllocations[system] / ticks;
+    }
+    std::cout << "\n";
+}
+
+int main(int argc, char * argv[])
+{
+    std::string name = PERF_SEGMENT;
+    std::string csvPath;
+    size_t windowSize = 600;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+
+        if (arg == "--name" && i + 1 < argc)
+        {
+            name = argv[++i];
+        }
+        else if (arg == "--csv" && i + 1 < argc)
+        {
+            csvPath = argv[++i];
+        }
+        else if (arg == "--window" && i + 1 < argc)
+        {
+            windowSize = std::max(1, std::atoi(argv[++i]));
+        }
+        else
+        {
+            std::cout << "Usage: PerfMonitor.exe [--name <segment>] [--csv <file>] [--window <ticks>]\n";
+            return 1;
+        }
+    }
+
+    PerfReader reader;
+    if (!reader.open(name))
+    {
+        std::cout << "Error with opening performance counters " << name << " (is the game running?).\n";
+        return 1;
+    }
+
+    std::ofstream csv;
+    if (!csvPath.empty())
+    {
+        csv.open(csvPath);
+        if (!csv)
+        {
+            std::cout << "Error with opening " << csvPath << ".\n";
+            return 1;
+        }
+        writeCsvHeader(csv);
+    }
+
+    std::deque<PerfFrame> window;
+    std::uint64_t next = reader.written();
+    std::uint64_t missed = 0;
+    int idleSeconds = 0;
+
+    while (idleSeconds < 3)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        // Anything older than the ring has been overwritten already
+        const std::uint64_t written = reader.written();
+        if (written - next > PERF_RING_SIZE)
+        {
+            missed += written - PERF_RING_SIZE - next;
+            next = written - PERF_RING_SIZE;
+        }
+
+        idleSeconds = next == written ? idleSeconds + 1 : 0;
+
+        for (; next < written; next++)
+        {
+            PerfFrame frame;
+            if (!reader.read(next, frame))
+            {
+                missed++;
+                continue;
+            }
+
+            if (csv.is_open())
+            {
+                writeCsvRow(csv, frame);
+            }
+
+            window.push_back(frame);
+            if (window.size() > windowSize)
+            {
+                window.pop_front();
+            }
+        }
+
+        if (!window.empty() && idleSeconds == 0)
+        {
+            printWindow(window, missed);
+        }
+    }
+
+    std::cout << "Game stopped publishing.\n";
+    return 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Small seedable random number generator (xorshift32).
+ * 
+ * Used instead of rand() so that randomness is part of the game's state: it can be saved and restored
+ * (netplay rollback), and two games started with the same seed play out the same.
+ */
+class Random
+{
+public:
+    Random(std::uint32_t seed = 1)
+    {
+        setSeed(seed);
+    }
+
+    void setSeed(std::uint32_t seed)
+    {
+        // xorshift gets stuck on 0
+        m_state = seed != 0 ? seed : 0x9E3779B9u;
+    }
+
+    std::uint32_t next()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    /**
+     * Returns a random number within the given range.
+     * 
+     * The range is from min (included) to max (included).
+     */
+    int fromRange(int min, int max)
+    {
+        return static_cast<int>(next() % static_cast<std::uint32_t>(1 + max - min)) + min;
+    }
+
+private:
+    std::uint32_t m_state;
+};
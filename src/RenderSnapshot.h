@@ -0,0 +1,84 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "PerfCounters.h"
+
+/**
+ * A shape to draw (an entity as the simulation last saw it). Colors already include fading.
+ */
+struct RenderShape
+{
+    float       x                   = 0;
+    float       y                   = 0;
+    float       angle               = 0;    // degrees
+    float       radius              = 0;
+    float       outlineThickness    = 0;
+    int         points              = 0;
+    sf::Color   fill;
+    sf::Color   outline;
+    size_t      id                  = 0;    // the entity's
+    std::uint32_t version           = 0;    // the entity's (the same as last snapshot's means it looks the same, see Entity::version())
+};
+
+/**
+ * What the debug overlay shows about the simulation (see Game::drawDebugOverlay()).
+ */
+struct DebugInfo
+{
+    float                       systemMs[FrameGovernor::SYSTEM_COUNT] = {};  // smoothed cost per tick
+    double                      pressure        = 0;
+    int                         entities[PERF_TAG_COUNT] = {};
+    int                         collisionTests  = 0;    // last tick
+    int                         collisionHits   = 0;
+    int                         contactCapacity = 0;
+    int                         aiThought       = 0;    // enemies the AI worked on last tick
+    long                        flowFieldBuilds = 0;
+    std::vector<float>          circles;                // collision circles in view: x, y, radius, ...
+
+    // The spawn grid's cells in view, as of the last enemy spawn
+    int                         gridCols        = 0;
+    int                         gridRows        = 0;
+    float                       gridCellSize    = 0;
+    float                       gridX           = 0;
+    float                       gridY           = 0;
+    std::vector<std::uint8_t>   gridFree;               // per cell, row by row
+};
+
+/**
+ * Everything needed to draw one frame.
+ * 
+ * The simulation publishes one after every tick, and the render thread draws the newest one. The render thread
+ * never touches the simulation's state, only snapshots.
+ */
+struct RenderSnapshot
+{
+    enum Scene { START_MENU, IN_GAME, GAME_OVER };
+
+    bool                        valid       = false;    // false until the simulation publishes its first snapshot
+    Scene                       scene       = START_MENU;
+    bool                        paused      = false;
+    std::vector<RenderShape>    shapes;                 // only those in view, in entity order
+    std::uint32_t               stateLoads  = 0;        // changes when the simulation goes back to a saved state (shapes' versions with it)
+    float                       cameraX     = 0;        // top left corner of the part of the world in view
+    float                       cameraY     = 0;
+
+    // HUD
+    int                         score       = 0;
+    int                         highScore   = 0;
+    int                         gameScore   = 0;
+    bool                        isNewHighScore  = false;
+    int                         diffNewHighScorePrevHighScore = 0;
+    bool                        nukeReady   = false;
+    float                       blinkAlpha  = 1;        // alpha percent of blinking text
+    int                         qualityLevel = 0;       // FrameGovernor::Level the shapes were made for
+
+    // Only filled in while the debug overlay is on
+    bool                        hasDebug    = false;
+    DebugInfo                   debug;
+
+    // When the input events simulated recently were taken from the window (for measuring input latency)
+    std::vector<std::chrono::steady_clock::time_point> inputTimes;
+};
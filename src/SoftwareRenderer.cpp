@@ -0,0 +1,659 @@
+#include "SoftwareRenderer.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    /**
+     * Which side of the line from a to b point p is on (twice the signed area of the triangle a, b, p).
+     */
+    float edge(float ax, float ay, float bx, float by, float px, float py)
+    {
+        return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+    }
+
+    /**
+     * Top-left fill rule: pixels exactly on an edge shared by two triangles are only drawn by one of them.
+     */
+    bool isTopLeft(float ax, float ay, float bx, float by)
+    {
+        const float dx = bx - ax;
+        const float dy = by - ay;
+        return dy < 0 || (dy == 0 && dx > 0);
+    }
+
+    // PNG chunks end with a CRC-32 of their type and data
+    std::uint32_t crc32(std::uint32_t crc, const std::uint8_t * data, size_t size)
+    {
+        static std::uint32_t table[256] = {};
+        if (table[1] == 0)
+        {
+            for (std::uint32_t n = 0; n < 256; n++)
+            {
+                std::uint32_t c = n;
+                for (int k = 0; k < 8; k++)
+                {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                table[n] = c;
+            }
+        }
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++)
+        {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    void putBigEndian(std::vector<std::uint8_t> & out, std::uint32_t value)
+    {
+        out.push_back(value >> 24);
+        out.push_back(value >> 16);
+        out.push_back(value >> 8);
+        out.push_back(value);
+    }
+
+    void writeChunk(std::ofstream & file, const char * type, const std::vector<std::uint8_t> & data)
+    {
+        std::vector<std::uint8_t> chunk;
+        putBigEndian(chunk, data.size());
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+        putBigEndian(chunk, crc32(0, chunk.data() + 4, chunk.size() - 4));
+        file.write(reinterpret_cast<const char *>(chunk.data()), chunk.size());
+    }
+}
+
+/**
+ * Creates a renderer (the image starts out black).
+ *
+ * width   - image width (pixels)
+ * height  - image height (pixels)
+ * threads - threads to rasterise with (0 means one per CPU core)
+ */
+SoftwareRenderer::SoftwareRenderer(int width, int height, int threads)
+    : m_width(width)
+    , m_height(height)
+    , m_threads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency()))
+    , m_pixels(width * height * 4, 0)
+    , m_tilesX((width + TILE_SIZE - 1) / TILE_SIZE)
+    , m_tilesY((height + TILE_SIZE - 1) / TILE_SIZE)
+{
+    m_tiles.resize(m_tilesX * m_tilesY);
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+    if (m_face != nullptr)
+    {
+        FT_Done_Face(static_cast<FT_Face>(m_face));
+    }
+    if (m_library != nullptr)
+    {
+        FT_Done_FreeType(static_cast<FT_Library>(m_library));
+    }
+}
+
+/**
+ * Loads the font text is drawn with. The data must stay around for as long as the renderer.
+ *
+ * Returns false if it can't be loaded.
+ */
+bool SoftwareRenderer::loadFont(const void * data, size_t size)
+{
+    FT_Library library;
+    if (FT_Init_FreeType(&library) != 0)
+    {
+        return false;
+    }
+    m_library = library;
+
+    FT_Face face;
+    if (FT_New_Memory_Face(library, static_cast<const FT_Byte *>(data), size, 0, &face) != 0)
+    {
+        return false;
+    }
+    m_face = face;
+    m_glyphs.clear();
+
+    return true;
+}
+
+/**
+ * Fills the whole image with one color, and forgets everything drawn since the last finish().
+ *
+ * The image is filled by finish() (tile by tile, on the rasterising threads).
+ */
+void SoftwareRenderer::clear(const sf::Color & color)
+{
+    m_clearColor = color;
+    m_clearPending = true;
+    m_primitives.clear();
+}
+
+/**
+ * Draws triangles (like sf::Triangles: every 3 vertices are a triangle). Colors are interpolated across each triangle.
+ */
+void SoftwareRenderer::drawTriangles(const sf::Vertex * vertices, size_t count, Blend blend)
+{
+    for (size_t i = 0; i + 2 < count; i += 3)
+    {
+        addTriangle(vertices[i], vertices[i + 1], vertices[i + 2], blend);
+    }
+}
+
+/**
+ * Draws lines (like sf::Lines: every 2 vertices are a line), 1 pixel wide.
+ */
+void SoftwareRenderer::drawLines(const sf::Vertex * vertices, size_t count, Blend blend)
+{
+    for (size_t i = 0; i + 1 < count; i += 2)
+    {
+        const sf::Vertex & a = vertices[i];
+        const sf::Vertex & b = vertices[i + 1];
+
+        // A line is a thin rectangle (2 triangles) around it
+        float dx = b.position.x - a.position.x;
+        float dy = b.position.y - a.position.y;
+        const float length = std::sqrt(dx * dx + dy * dy);
+        if (length > 0)
+        {
+            dx /= length;
+            dy /= length;
+        }
+        else
+        {
+            dx = 1;
+            dy = 0;
+        }
+        const sf::Vector2f normal(-dy * 0.5f, dx * 0.5f);
+
+        const sf::Vertex a0(a.position + normal, a.color);
+        const sf::Vertex a1(a.position - normal, a.color);
+        const sf::Vertex b0(b.position + normal, b.color);
+        const sf::Vertex b1(b.position - normal, b.color);
+        addTriangle(a0, a1, b0, blend);
+        addTriangle(b0, a1, b1, blend);
+    }
+}
+
+/**
+ * Draws text, placed like sf::Text does (position is the top left, the baseline is one character size below it).
+ *
+ * text  - what to write
+ * x, y  - where
+ * size  - character size (pixels)
+ * color - text color
+ */
+void SoftwareRenderer::drawText(const std::string & text, float x, float y, unsigned size, const sf::Color & color)
+{
+    if (m_face == nullptr)
+    {
+        return;
+    }
+
+    int penX = (int) std::lround(x);
+    const int baseline = (int) std::lround(y) + size;
+
+    for (unsigned char character : text)
+    {
+        const GlyphBitmap & bitmap = glyph(size, character);
+
+        if (bitmap.width > 0 && bitmap.height > 0)
+        {
+            Primitive p;
+            p.glyph = &bitmap;
+            p.minX = penX + bitmap.left;
+            p.minY = baseline - bitmap.top;
+            p.maxX = p.minX + bitmap.width - 1;
+            p.maxY = p.minY + bitmap.height - 1;
+            p.color[0] = color;
+            m_primitives.push_back(p);
+        }
+
+        penX += bitmap.advance;
+    }
+}
+
+/**
+ * What drawText() would cover, from where it's drawn (like sf::Text's getLocalBounds(), the same for any position).
+ *
+ * text  - what to write
+ * size  - character size (pixels)
+ */
+sf::FloatRect SoftwareRenderer::textBounds(const std::string & text, unsigned size)
+{
+    if (m_face == nullptr)
+    {
+        return sf::FloatRect();
+    }
+
+    int penX = 0;
+    int minX = 0;
+    int minY = 0;
+    int maxX = 0;
+    int maxY = 0;
+    bool empty = true;
+
+    for (unsigned char character : text)
+    {
+        const GlyphBitmap & bitmap = glyph(size, character);
+
+        if (bitmap.width > 0 && bitmap.height > 0)
+        {
+            const int left = penX + bitmap.left;
+            const int top = (int) size - bitmap.top;
+            minX = empty ? left : std::min(minX, left);
+            minY = empty ? top : std::min(minY, top);
+            maxX = empty ? left + bitmap.width : std::max(maxX, left + bitmap.width);
+            maxY = empty ? top + bitmap.height : std::max(maxY, top + bitmap.height);
+            empty = false;
+        }
+
+        penX += bitmap.advance;
+    }
+
+    return sf::FloatRect(minX, minY, maxX - minX, maxY - minY);
+}
+
+/**
+ * Rasterises everything drawn since the last clear() or finish() into the image.
+ */
+void SoftwareRenderer::finish()
+{
+    // Bin primitives into the tiles their bounding box touches
+    for (std::vector<std::uint32_t> & tile : m_tiles)
+    {
+        tile.clear();
+    }
+
+    for (size_t i = 0; i < m_primitives.size(); i++)
+    {
+        const Primitive & p = m_primitives[i];
+        if (p.maxX < 0 || p.maxY < 0 || p.minX >= m_width || p.minY >= m_height)
+        {
+            continue;
+        }
+
+        const int tx0 = std::max(0, p.minX) / TILE_SIZE;
+        const int ty0 = std::max(0, p.minY) / TILE_SIZE;
+        const int tx1 = std::min(m_width - 1, p.maxX) / TILE_SIZE;
+        const int ty1 = std::min(m_height - 1, p.maxY) / TILE_SIZE;
+        for (int ty = ty0; ty <= ty1; ty++)
+        {
+            for (int tx = tx0; tx <= tx1; tx++)
+            {
+                m_tiles[ty * m_tilesX + tx].push_back(i);
+            }
+        }
+    }
+
+    // Threads take tiles one at a time until there are none left (no two threads ever touch the same pixel)
+    std::atomic<int> nextTile { 0 };
+    auto work = [this, &nextTile]()
+    {
+        for (int tile = nextTile++; tile < (int) m_tiles.size(); tile = nextTile++)
+        {
+            rasteriseTile(tile);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < m_threads; i++)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+
+    m_primitives.clear();
+    m_clearPending = false;
+}
+
+int SoftwareRenderer::width() const
+{
+    return m_width;
+}
+
+int SoftwareRenderer::height() const
+{
+    return m_height;
+}
+
+/**
+ * Returns the image (RGBA, 4 bytes per pixel, rows top to bottom).
+ */
+const std::vector<std::uint8_t> & SoftwareRenderer::pixels() const
+{
+    return m_pixels;
+}
+
+/**
+ * Returns a checksum of the image (FNV-1a), for comparing against a known good image.
+ */
+std::uint64_t SoftwareRenderer::checksum() const
+{
+    std::uint64_t hash = 1469598103934665603ULL;
+    for (std::uint8_t b : m_pixels)
+    {
+        hash = (hash ^ b) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Saves the image as PNG or PPM (by the file's extension: .ppm is PPM, anything else is PNG).
+ *
+ * Returns false if the file can't be written.
+ */
+bool SoftwareRenderer::save(const std::string & path) const
+{
+    const bool ppm = path.size() >= 4 && path.compare(path.size() - 4, 4, ".ppm") == 0;
+    return ppm ? savePPM(path) : savePNG(path);
+}
+
+/**
+ * Saves the image as binary PPM (RGB, alpha is dropped).
+ */
+bool SoftwareRenderer::savePPM(const std::string & path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "P6\n" << m_width << " " << m_height << "\n255\n";
+    for (size_t i = 0; i < m_pixels.size(); i += 4)
+    {
+        file.write(reinterpret_cast<const char *>(&m_pixels[i]), 3);
+    }
+
+    return (bool) file;
+}
+
+/**
+ * Saves the image as PNG (RGBA). The image data is stored without compression, so no zlib is needed.
+ */
+bool SoftwareRenderer::savePNG(const std::string & path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    const std::uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write(reinterpret_cast<const char *>(signature), sizeof(signature));
+
+    // 8 bits per channel, RGBA, no interlacing
+    std::vector<std::uint8_t> header;
+    putBigEndian(header, m_width);
+    putBigEndian(header, m_height);
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });
+    writeChunk(file, "IHDR", header);
+
+    // Rows, each starting with filter type 0 (none)
+    std::vector<std::uint8_t> raw;
+    raw.reserve((m_width * 4 + 1) * m_height);
+    for (int y = 0; y < m_height; y++)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), m_pixels.begin() + y * m_width * 4, m_pixels.begin() + (y + 1) * m_width * 4);
+    }
+
+    // zlib stream made of stored (uncompressed) deflate blocks
+    std::vector<std::uint8_t> data = { 0x78, 0x01 };
+    const size_t MAX_BLOCK = 65535;
+    for (size_t offset = 0; offset < raw.size() || offset == 0; offset += MAX_BLOCK)
+    {
+        const size_t size = std::min(MAX_BLOCK, raw.size() - offset);
+        const bool last = offset + size >= raw.size();
+        data.push_back(last ? 1 : 0);
+        data.push_back(size & 0xFF);
+        data.push_back(size >> 8);
+        data.push_back(~size & 0xFF);
+        data.push_back((~size >> 8) & 0xFF);
+        data.insert(data.end(), raw.begin() + offset, raw.begin() + offset + size);
+        if (last)
+        {
+            break;
+        }
+    }
+
+    std::uint32_t a = 1, b = 0;
+    for (std::uint8_t byte : raw)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBigEndian(data, (b << 16) | a);
+    writeChunk(file, "IDAT", data);
+
+    writeChunk(file, "IEND", std::vector<std::uint8_t>());
+
+    return (bool) file;
+}
+
+void SoftwareRenderer::addTriangle(const sf::Vertex & a, const sf::Vertex & b, const sf::Vertex & c, Blend blend)
+{
+    Primitive p;
+    p.blend = blend;
+
+    // Wind every triangle the same way, so "inside" is where all edge functions are positive
+    const bool flip = edge(a.position.x, a.position.y, b.position.x, b.position.y, c.position.x, c.position.y) < 0;
+    const sf::Vertex * v[3] = { &a, flip ? &c : &b, flip ? &b : &c };
+    for (int i = 0; i < 3; i++)
+    {
+        p.x[i] = v[i]->position.x;
+        p.y[i] = v[i]->position.y;
+        p.color[i] = v[i]->color;
+    }
+
+    p.minX = (int) std::floor(std::min({ p.x[0], p.x[1], p.x[2] }));
+    p.minY = (int) std::floor(std::min({ p.y[0], p.y[1], p.y[2] }));
+    p.maxX = (int) std::ceil(std::max({ p.x[0], p.x[1], p.x[2] }));
+    p.maxY = (int) std::ceil(std::max({ p.y[0], p.y[1], p.y[2] }));
+
+    m_primitives.push_back(p);
+}
+
+const SoftwareRenderer::GlyphBitmap & SoftwareRenderer::glyph(unsigned size, std::uint32_t character)
+{
+    const std::pair<unsigned, std::uint32_t> key(size, character);
+    auto found = m_glyphs.find(key);
+    if (found != m_glyphs.end())
+    {
+        return found->second;
+    }
+
+    GlyphBitmap & bitmap = m_glyphs[key];
+
+    FT_Face face = static_cast<FT_Face>(m_face);
+    if (FT_Set_Pixel_Sizes(face, 0, size) != 0 || FT_Load_Char(face, character, FT_LOAD_RENDER) != 0)
+    {
+        std::cout << "Error with rendering character " << character << ".\n";
+        return bitmap;
+    }
+
+    const FT_Bitmap & ft = face->glyph->bitmap;
+    bitmap.width = ft.width;
+    bitmap.height = ft.rows;
+    bitmap.left = face->glyph->bitmap_left;
+    bitmap.top = face->glyph->bitmap_top;
+    bitmap.advance = face->glyph->advance.x >> 6;
+    bitmap.coverage.resize(bitmap.width * bitmap.height);
+    for (int y = 0; y < bitmap.height; y++)
+    {
+        std::copy(ft.buffer + y * ft.pitch, ft.buffer + y * ft.pitch + bitmap.width, bitmap.coverage.begin() + y * bitmap.width);
+    }
+
+    return bitmap;
+}
+
+void SoftwareRenderer::rasteriseTile(int tile)
+{
+    const int x0 = (tile % m_tilesX) * TILE_SIZE;
+    const int y0 = (tile / m_tilesX) * TILE_SIZE;
+    const int x1 = std::min(x0 + TILE_SIZE, m_width) - 1;
+    const int y1 = std::min(y0 + TILE_SIZE, m_height) - 1;
+
+    if (m_clearPending)
+    {
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                std::uint8_t * pixel = &m_pixels[(y * m_width + x) * 4];
+                pixel[0] = m_clearColor.r;
+                pixel[1] = m_clearColor.g;
+                pixel[2] = m_clearColor.b;
+                pixel[3] = m_clearColor.a;
+            }
+        }
+    }
+
+    for (std::uint32_t i : m_tiles[tile])
+    {
+        const Primitive & p = m_primitives[i];
+        if (p.glyph != nullptr)
+        {
+            rasteriseGlyph(p, x0, y0, x1, y1);
+        }
+        else
+        {
+            rasteriseTriangle(p, x0, y0, x1, y1);
+        }
+    }
+}
+
+/**
+ * Draws the part of a triangle inside the given rectangle (pixels, inclusive). Pixels whose centers are inside are drawn.
+ */
+void SoftwareRenderer::rasteriseTriangle(const Primitive & p, int x0, int y0, int x1, int y1)
+{
+    const float area = edge(p.x[0], p.y[0], p.x[1], p.y[1], p.x[2], p.y[2]);
+    if (area <= 0)
+    {
+        return;
+    }
+
+    const bool topLeft[3] = { isTopLeft(p.x[1], p.y[1], p.x[2], p.y[2]), isTopLeft(p.x[2], p.y[2], p.x[0], p.y[0]), isTopLeft(p.x[0], p.y[0], p.x[1], p.y[1]) };
+    const bool flat = p.color[0] == p.color[1] && p.color[1] == p.color[2];
+
+    const int minX = std::max(x0, p.minX);
+    const int minY = std::max(y0, p.minY);
+    const int maxX = std::min(x1, p.maxX);
+    const int maxY = std::min(y1, p.maxY);
+
+    for (int y = minY; y <= maxY; y++)
+    {
+        const float py = y + 0.5f;
+        for (int x = minX; x <= maxX; x++)
+        {
+            const float px = x + 0.5f;
+            const float w[3] = {
+                edge(p.x[1], p.y[1], p.x[2], p.y[2], px, py),
+                edge(p.x[2], p.y[2], p.x[0], p.y[0], px, py),
+                edge(p.x[0], p.y[0], p.x[1], p.y[1], px, py),
+            };
+
+            bool inside = true;
+            for (int k = 0; k < 3; k++)
+            {
+                inside = inside && (w[k] > 0 || (w[k] == 0 && topLeft[k]));
+            }
+            if (!inside)
+            {
+                continue;
+            }
+
+            if (flat)
+            {
+                blendPixel(x, y, p.color[0], 1, p.blend);
+            }
+            else
+            {
+                // Interpolate the vertex colors
+                float channels[4] = {};
+                for (int k = 0; k < 3; k++)
+                {
+                    const float weight = w[k] / area;
+                    channels[0] += p.color[k].r * weight;
+                    channels[1] += p.color[k].g * weight;
+                    channels[2] += p.color[k].b * weight;
+                    channels[3] += p.color[k].a * weight;
+                }
+                const sf::Color color((sf::Uint8) std::lround(channels[0]), (sf::Uint8) std::lround(channels[1]), (sf::Uint8) std::lround(channels[2]), (sf::Uint8) std::lround(channels[3]));
+                blendPixel(x, y, color, 1, p.blend);
+            }
+        }
+    }
+}
+
+/**
+ * Draws the part of a glyph inside the given rectangle (pixels, inclusive).
+ */
+void SoftwareRenderer::rasteriseGlyph(const Primitive & p, int x0, int y0, int x1, int y1)
+{
+    const int minX = std::max(x0, p.minX);
+    const int minY = std::max(y0, p.minY);
+    const int maxX = std::min(x1, p.maxX);
+    const int maxY = std::min(y1, p.maxY);
+
+    for (int y = minY; y <= maxY; y++)
+    {
+        for (int x = minX; x <= maxX; x++)
+        {
+            const std::uint8_t coverage = p.glyph->coverage[(y - p.minY) * p.glyph->width + (x - p.minX)];
+            if (coverage > 0)
+            {
+                blendPixel(x, y, p.color[0], coverage / 255.0f, p.blend);
+            }
+        }
+    }
+}
+
+/**
+ * Blends a color into a pixel, the way SFML's blend modes do.
+ *
+ * coverage - how much of the pixel the color covers (0 to 1), multiplies its alpha
+ */
+void SoftwareRenderer::blendPixel(int x, int y, const sf::Color & color, float coverage, Blend blend)
+{
+    std::uint8_t * pixel = &m_pixels[(y * m_width + x) * 4];
+    const float alpha = color.a / 255.0f * coverage;
+    const float source[3] = { (float) color.r, (float) color.g, (float) color.b };
+
+    if (blend == ADD)
+    {
+        // Color: source * alpha + destination, alpha: source + destination
+        for (int k = 0; k < 3; k++)
+        {
+            pixel[k] = (std::uint8_t) std::min(255.0f, pixel[k] + source[k] * alpha + 0.5f);
+        }
+        pixel[3] = (std::uint8_t) std::min(255.0f, pixel[3] + alpha * 255 + 0.5f);
+    }
+    else
+    {
+        // Color: source * alpha + destination * (1 - alpha), alpha: source + destination * (1 - alpha)
+        for (int k = 0; k < 3; k++)
+        {
+            pixel[k] = (std::uint8_t) (source[k] * alpha + pixel[k] * (1 - alpha) + 0.5f);
+        }
+        pixel[3] = (std::uint8_t) (alpha * 255 + pixel[3] * (1 - alpha) + 0.5f);
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Draws into an RGBA image in memory, on the CPU (no GPU or display needed).
+ *
+ * Takes the same vertices the game gives SFML (triangles and lines), plus text drawn with the game's font. Drawing
+ * only records what to draw; finish() rasterises it all, with the image split into tiles that are shared out between
+ * threads. Each tile draws its primitives in the order they were given, so the result is the same with any number of
+ * threads (which is what makes it usable for golden image comparisons).
+ */
+class SoftwareRenderer
+{
+public:
+    enum Blend { ALPHA, ADD };  // sf::BlendAlpha, sf::BlendAdd
+
+    SoftwareRenderer(int width, int height, int threads = 0);
+    ~SoftwareRenderer();
+
+    bool loadFont(const void * data, size_t size);
+
+    void clear(const sf::Color & color);
+    void drawTriangles(const sf::Vertex * vertices, size_t count, Blend blend = ALPHA);
+    void drawLines(const sf::Vertex * vertices, size_t count, Blend blend = ALPHA);
+    void drawText(const std::string & text, float x, float y, unsigned size, const sf::Color & color);
+    sf::FloatRect textBounds(const std::string & text, unsigned size);
+    void finish();
+
+    int width() const;
+    int height() const;
+    const std::vector<std::uint8_t> & pixels() const;
+    std::uint64_t checksum() const;
+
+    bool save(const std::string & path) const;
+    bool savePPM(const std::string & path) const;
+    bool savePNG(const std::string & path) const;
+
+private:
+    static const int TILE_SIZE = 64;
+
+    struct GlyphBitmap
+    {
+        int                         width   = 0;
+        int                         height  = 0;
+        int                         left    = 0;    // from the pen position to the bitmap's left edge
+        int                         top     = 0;    // from the baseline up to the bitmap's top edge
+        int                         advance = 0;
+        std::vector<std::uint8_t>   coverage;
+    };
+
+    // A triangle, or a glyph (a rectangle of coverage values in one color)
+    struct Primitive
+    {
+        Blend                   blend   = ALPHA;
+        int                     minX    = 0;    // bounding box (pixels, inclusive)
+        int                     minY    = 0;
+        int                     maxX    = 0;
+        int                     maxY    = 0;
+        float                   x[3]    = {};
+        float                   y[3]    = {};
+        sf::Color               color[3];
+        const GlyphBitmap *     glyph   = nullptr;
+    };
+
+    int                                     m_width;
+    int                                     m_height;
+    int                                     m_threads;
+    std::vector<std::uint8_t>               m_pixels;
+    sf::Color                               m_clearColor;
+    bool                                    m_clearPending  = false;
+    std::vector<Primitive>                  m_primitives;
+    std::vector<std::vector<std::uint32_t>> m_tiles;    // primitives touching each tile, in drawing order
+    int                                     m_tilesX;
+    int                                     m_tilesY;
+
+    void *                                  m_library   = nullptr;  // FT_Library
+    void *                                  m_face      = nullptr;  // FT_Face
+    std::map<std::pair<unsigned, std::uint32_t>, GlyphBitmap> m_glyphs;   // by (size, character)
+
+    void addTriangle(const sf::Vertex & a, const sf::Vertex & b, const sf::Vertex & c, Blend blend);
+    const GlyphBitmap & glyph(unsigned size, std::uint32_t character);
+    void rasteriseTile(int tile);
+    void rasteriseTriangle(const Primitive & p, int x0, int y0, int x1, int y1);
+    void rasteriseGlyph(const Primitive & p, int x0, int y0, int x1, int y1);
+    void blendPixel(int x, int y, const sf::Color & color, float coverage, Blend blend);
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * A sound effect the simulation asks for (e.g. a shot, or an enemy blowing up). AudioSystem (Audio.h) plays them.
+ */
+struct SoundEffect
+{
+    enum Type : std::uint8_t { SHOT, SPLIT, KILL, DEATH, NUKE, TYPE_COUNT };
+
+    Type    type    = SHOT;
+    float   volume  = 1;    // relative to the effect's own (e.g. small enemies blow up quieter)
+};
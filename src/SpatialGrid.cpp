@@ -0,0 +1,51 @@
+#include "SpatialGrid.h"
+
+/**
+ * Makes room for count points, so builds with up to that many don't allocate.
+ */
+void SpatialGrid::reserve(std::uint32_t count)
+{
+    m_items.reserve(count);
+    m_cellOf.reserve(count);
+}
+
+/**
+ * Sorts points into cells (replacing what was there before).
+ * 
+ * positions - the points
+ * count     - how many points there are
+ * cellSize  - size of a cell (about the size of what's being looked for works best)
+ * width     - width of the area, from 0
+ * height    - height of the area, from 0
+ */
+void SpatialGrid::build(const Vec2 * positions, std::uint32_t count, float cellSize, float width, float height)
+{
+    m_cellSize = cellSize;
+    m_cols = std::max(1, (int) (width / cellSize) + 1);
+    m_rows = std::max(1, (int) (height / cellSize) + 1);
+
+    // Count the points in each cell, turn the counts into start positions, then put each point in its place
+    m_cellStart.assign(m_cols * m_rows + 1, 0);
+    m_cellOf.resize(count);
+    for (std::uint32_t i = 0; i < count; i++)
+    {
+        m_cellOf[i] = row(toFloat(positions[i].y)) * m_cols + col(toFloat(positions[i].x));
+        m_cellStart[m_cellOf[i] + 1]++;
+    }
+    for (size_t cell = 1; cell < m_cellStart.size(); cell++)
+    {
+        m_cellStart[cell] += m_cellStart[cell - 1];
+    }
+
+    // Fill in cell by cell (m_cellStart[cell] is moved along while filling, then moved back)
+    m_items.resize(count);
+    for (std::uint32_t i = 0; i < count; i++)
+    {
+        m_items[m_cellStart[m_cellOf[i]]++] = i;
+    }
+    for (size_t cell = m_cellStart.size() - 1; cell > 0; cell--)
+    {
+        m_cellStart[cell] = m_cellStart[cell - 1];
+    }
+    m_cellStart[0] = 0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Vec2.h"
+
+/**
+ * Uniform grid broadphase: finds the points near a place without looking at every point.
+ * 
+ * build() sorts the points into square cells (a counting sort, so it's two passes over the points and one over the
+ * cells, and the memory is kept between builds). Points outside the area go in the nearest edge cell, so nothing is
+ * ever missed, it just costs more to look there.
+ */
+class SpatialGrid
+{
+public:
+    void reserve(std::uint32_t count);
+    void build(const Vec2 * positions, std::uint32_t count, float cellSize, float width, float height);
+
+    /**
+     * Calls visit(index) for every point in the cells that the square around (x, y) touches (a superset of the
+     * points within radius of (x, y), in no particular order).
+     */
+    template <typename Visit>
+    void query(float x, float y, float radius, Visit visit) const
+    {
+        const int minCol = col(x - radius);
+        const int maxCol = col(x + radius);
+        const int minRow = row(y - radius);
+        const int maxRow = row(y + radius);
+
+        for (int r = minRow; r <= maxRow; r++)
+        {
+            for (int c = minCol; c <= maxCol; c++)
+            {
+                const int cell = r * m_cols + c;
+                for (std::uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; i++)
+                {
+                    visit(m_items[i]);
+                }
+            }
+        }
+    }
+
+    int cols() const { return m_cols; }
+    int rows() const { return m_rows; }
+    float cellSize() const { return m_cellSize; }
+
+private:
+    int                         m_cols      = 0;
+    int                         m_rows      = 0;
+    float                       m_cellSize  = 1;
+    std::vector<std::uint32_t>  m_cellStart;    // where each cell's points start in m_items (one extra at the end)
+    std::vector<std::uint32_t>  m_items;        // point indexes, cell by cell
+    std::vector<std::uint32_t>  m_cellOf;       // each point's cell
+
+    int col(float x) const { return std::min(m_cols - 1, std::max(0, (int) (x / m_cellSize))); }
+    int row(float y) const { return std::min(m_rows - 1, std::max(0, (int) (y / m_cellSize))); }
+};
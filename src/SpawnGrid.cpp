@@ -0,0 +1,297 @@
+#include "SpawnGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Sets the grid up for an area, with every cell free (and no circles counted), unless it already is (then it's left
+ * as it is).
+ *
+ * width    - width of the area to spawn in
+ * height   - height of the area to spawn in
+ * cellSize - size of a cell (at least 2 * radius, anything more is used for jitter)
+ * radius   - radius of the circles that will be placed (and counted, which mustn't be any bigger)
+ *
+ * Returns true if the grid was set up again (the circles have to be added again).
+ */
+bool SpawnGrid::fit(int width, int height, int cellSize, int radius)
+{
+    if (width == m_width && height == m_height && std::max(cellSize, 2 * radius) == m_cellSize && radius == m_radius)
+    {
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_cellSize = std::max(cellSize, 2 * radius);
+    m_radius = radius;
+    m_jitter = m_cellSize / 2 - radius;
+    m_cols = std::max(0, width / m_cellSize);
+    m_rows = std::max(0, height / m_cellSize);
+    m_originX = (width - m_cols * m_cellSize) / 2.0f;
+    m_originY = (height - m_rows * m_cellSize) / 2.0f;
+
+    const int cells = m_cols * m_rows;
+    m_free = cells;
+    m_blockers.assign(cells, 0);
+    m_circles.assign(cells, 0);
+    m_blocked.clear();
+
+    // Every cell is free (a Fenwick tree of all ones: each node counts the cells it covers)
+    m_tree.assign(cells + 1, 0);
+    for (int i = 1; i <= cells; i++)
+    {
+        m_tree[i] = i & -i;
+    }
+
+    // A counted circle can be anywhere in its cell (or in the edge the grid leaves out, next to it), and a placed
+    // one up to the jitter (diagonally) from its cell's center
+    const float anywhere = std::sqrt((m_cellSize / 2.0f + m_originX) * (m_cellSize / 2.0f + m_originX) + (m_cellSize / 2.0f + m_originY) * (m_cellSize / 2.0f + m_originY));
+    const float reach = 2 * m_radius + m_jitter * 1.4143f + anywhere;
+    const int most = (int) std::ceil(reach / m_cellSize);
+
+    m_neighbours.clear();
+    for (int row = -most; row <= most; row++)
+    {
+        for (int col = -most; col <= most; col++)
+        {
+            const float dx = (float) col * m_cellSize;
+            const float dy = (float) row * m_cellSize;
+            if (dx * dx + dy * dy < reach * reach)
+            {
+                m_neighbours.push_back(Offset{ col, row });
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Counts a circle in the cell it's in (occupying it, if it's the first). Circles outside the grid (in the edges of
+ * the area it leaves out) count as in the nearest cell.
+ *
+ * x, y     - center of the circle
+ *
+ * Returns the cell it's counted in (for move() and remove()), -1 if the grid has no cells (it isn't counted).
+ */
+int SpawnGrid::add(float x, float y)
+{
+    if (m_blockers.empty())
+    {
+        return -1;
+    }
+
+    const int cell = cellAt(x, y);
+    if (m_circles[cell]++ == 0)
+    {
+        occupy(cell);
+    }
+    return cell;
+}
+
+/**
+ * A counted circle moved: it's counted in the cell it's in now instead (nothing changes if that's the same one).
+ *
+ * cell     - the cell it was counted in (-1 if it isn't: then it's left uncounted)
+ * x, y     - center of the circle now
+ *
+ * Returns the cell it's counted in now.
+ */
+int SpawnGrid::move(int cell, float x, float y)
+{
+    if (cell < 0 || cellAt(x, y) == cell)
+    {
+        return cell;
+    }
+
+    remove(cell);
+    return add(x, y);
+}
+
+/**
+ * Stops counting a circle (it's gone): its cell is freed, with the cells it blocked, if it was the last one in it.
+ *
+ * cell     - the cell it was counted in (-1 if it isn't: then nothing changes)
+ */
+void SpawnGrid::remove(int cell)
+{
+    if (cell >= 0 && --m_circles[cell] == 0)
+    {
+        vacate(cell);
+    }
+}
+
+/**
+ * Stops counting every circle (before adding them all again, e.g. after they were all put back somewhere else).
+ */
+void SpawnGrid::removeAll()
+{
+    for (int cell = 0; cell < (int) m_circles.size(); cell++)
+    {
+        if (m_circles[cell] > 0)
+        {
+            m_circles[cell] = 0;
+            vacate(cell);
+        }
+    }
+}
+
+/**
+ * Blocks every cell a circle placed in it could overlap the given circle from, until clearBlocks().
+ *
+ * x, y     - center of the circle
+ * radius   - radius of the circle
+ */
+void SpawnGrid::block(float x, float y, float radius)
+{
+    // A placed circle can be up to its radius plus the jitter (diagonally) from its cell's center
+    const float reach = radius + m_radius + m_jitter * 1.4143f;
+
+    const int minCol = std::max(0, (int) std::floor((x - reach - m_originX) / m_cellSize));
+    const int maxCol = std::min(m_cols - 1, (int) std::floor((x + reach - m_originX) / m_cellSize));
+    const int minRow = std::max(0, (int) std::floor((y - reach - m_originY) / m_cellSize));
+    const int maxRow = std::min(m_rows - 1, (int) std::floor((y + reach - m_originY) / m_cellSize));
+
+    for (int row = minRow; row <= maxRow; row++)
+    {
+        for (int col = minCol; col <= maxCol; col++)
+        {
+            const float dx = m_originX + (col + 0.5f) * m_cellSize - x;
+            const float dy = m_originY + (row + 0.5f) * m_cellSize - y;
+            if (dx * dx + dy * dy < reach * reach)
+            {
+                addBlocker(row * m_cols + col, 1);
+                m_blocked.push_back(row * m_cols + col);
+            }
+        }
+    }
+}
+
+/**
+ * Undoes every block() (the cells only occupied cells block are left blocked).
+ */
+void SpawnGrid::clearBlocks()
+{
+    for (int cell : m_blocked)
+    {
+        addBlocker(cell, -1);
+    }
+    m_blocked.clear();
+}
+
+/**
+ * Picks a random free cell and returns a spawn point in it. The new circle is counted in its cell (like add()), so
+ * taking again never gives an overlapping point.
+ *
+ * random   - where the random choices come from
+ * x, y     - set to the spawn point
+ *
+ * Returns the cell the new circle is counted in, -1 (and leaves x & y alone) if there are no free cells.
+ */
+int SpawnGrid::take(Random & random, float & x, float & y)
+{
+    if (m_free == 0)
+    {
+        return -1;
+    }
+
+    const int cell = nthFree(random.fromRange(0, (int) m_free - 1));
+    x = m_originX + (cell % m_cols + 0.5f) * m_cellSize + random.fromRange(-m_jitter, m_jitter);
+    y = m_originY + (cell / m_cols + 0.5f) * m_cellSize + random.fromRange(-m_jitter, m_jitter);
+
+    // (a free cell has no circles: an occupied cell always blocks itself)
+    m_circles[cell] = 1;
+    occupy(cell);
+    return cell;
+}
+
+size_t SpawnGrid::freeCount() const
+{
+    return m_free;
+}
+
+// The cell a point is in (or the nearest one, if it's outside the grid)
+int SpawnGrid::cellAt(float x, float y) const
+{
+    const int col = std::min(m_cols - 1, std::max(0, (int) std::floor((x - m_originX) / m_cellSize)));
+    const int row = std::min(m_rows - 1, std::max(0, (int) std::floor((y - m_originY) / m_cellSize)));
+    return row * m_cols + col;
+}
+
+// Marks a cell occupied, which blocks the cells around it
+void SpawnGrid::occupy(int cell)
+{
+    const int col = cell % m_cols;
+    const int row = cell / m_cols;
+    for (const Offset & offset : m_neighbours)
+    {
+        if (col + offset.col >= 0 && col + offset.col < m_cols && row + offset.row >= 0 && row + offset.row < m_rows)
+        {
+            addBlocker(cell + offset.row * m_cols + offset.col, 1);
+        }
+    }
+}
+
+// Undoes occupy()'s blocking
+void SpawnGrid::vacate(int cell)
+{
+    const int col = cell % m_cols;
+    const int row = cell / m_cols;
+    for (const Offset & offset : m_neighbours)
+    {
+        if (col + offset.col >= 0 && col + offset.col < m_cols && row + offset.row >= 0 && row + offset.row < m_rows)
+        {
+            addBlocker(cell + offset.row * m_cols + offset.col, -1);
+        }
+    }
+}
+
+// Adds to (or takes from) what's blocking a cell, and keeps the free cells' count and tree up to date
+void SpawnGrid::addBlocker(int cell, int change)
+{
+    const int before = m_blockers[cell];
+    m_blockers[cell] += change;
+
+    int freed = 0;
+    if (before == 0 && m_blockers[cell] > 0)
+    {
+        freed = -1;
+    }
+    else if (before > 0 && m_blockers[cell] == 0)
+    {
+        freed = 1;
+    }
+    if (freed == 0)
+    {
+        return;
+    }
+
+    m_free += freed;
+    for (int i = cell + 1; i < (int) m_tree.size(); i += i & -i)
+    {
+        m_tree[i] += freed;
+    }
+}
+
+// The n-th free cell (from 0), counting row by row (walks down the tree: each step halves the cells left to look at)
+int SpawnGrid::nthFree(int n) const
+{
+    const int cells = (int) m_tree.size() - 1;
+    int step = 1;
+    while (step * 2 <= cells)
+    {
+        step *= 2;
+    }
+
+    int position = 0;
+    int left = n + 1;
+    for (; step > 0; step /= 2)
+    {
+        if (position + step <= cells && m_tree[position + step] < left)
+        {
+            position += step;
+            left -= m_tree[position];
+        }
+    }
+    return position;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "Random.h"
+
+/**
+ * Coarse occupancy grid for picking spawn points.
+ *
+ * The area is split into square cells, each of which can hold one spawned circle (placed at the cell's center, give
+ * or take some jitter). Spawn points are only ever drawn from the cells left free: picking one is a single random
+ * choice, never a reroll, and circles placed in a row from the same grid never overlap each other.
+ *
+ * The grid counts the circles in each cell (a cell with any is occupied), and blocks every cell a circle placed in it
+ * could overlap an occupied cell's circle from (wherever in its cell that is, so it's a little wider than the circle).
+ * The owner keeps it up to date as circles come, move and go (add(), move() and remove(), each only touching one or
+ * two cells), remembering the cell each of its circles is counted in. Anything else (e.g. a no-spawn zone) blocks the
+ * cells it could overlap with block(), until clearBlocks().
+ *
+ * Which free cell gets picked only depends on which cells are free (not on the order they were blocked and freed in),
+ * so a grid counting the same circles always picks the same spawn points (netplay rollback doesn't need to save it,
+ * only to add the circles again after a load).
+ */
+class SpawnGrid
+{
+public:
+    bool fit(int width, int height, int cellSize, int radius);
+    int add(float x, float y);
+    int move(int cell, float x, float y);
+    void remove(int cell);
+    void removeAll();
+    void block(float x, float y, float radius);
+    void clearBlocks();
+    int take(Random & random, float & x, float & y);
+    size_t freeCount() const;
+
+    int cols() const { return m_cols; }
+    int rows() const { return m_rows; }
+    int cellSize() const { return m_cellSize; }
+    float originX() const { return m_originX; }
+    float originY() const { return m_originY; }
+    bool isFree(int cell) const { return m_blockers[cell] == 0; }
+
+private:
+    // Where a cell is from another (in cells)
+    struct Offset { int col, row; };
+
+    int                 m_width     = 0;
+    int                 m_height    = 0;
+    int                 m_cols      = 0;
+    int                 m_rows      = 0;
+    int                 m_cellSize  = 0;
+    int                 m_radius    = 0;    // of the circles being placed
+    int                 m_jitter    = 0;    // most a placed circle's center is moved from its cell's center (on each axis)
+    float               m_originX   = 0;    // top left of the grid (it's centered in the area)
+    float               m_originY   = 0;
+    size_t              m_free      = 0;    // free cells
+    std::vector<int>    m_blockers;         // per cell: occupied cells (and blocks) near enough to keep it from being free
+    std::vector<int>    m_circles;          // per cell: circles counted in it
+    std::vector<Offset> m_neighbours;       // the cells an occupied cell blocks
+    std::vector<int>    m_blocked;          // cells block() blocked (once for each time)
+    std::vector<int>    m_tree;             // free cells, as a Fenwick tree (for picking the n-th free cell in order)
+
+    int cellAt(float x, float y) const;
+    void occupy(int cell);
+    void vacate(int cell);
+    void addBlocker(int cell, int change);
+    int nthFree(int n) const;
+};
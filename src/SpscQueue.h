@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Lock-free fixed size queue for one producer thread and one consumer thread.
+ * 
+ * push() never waits: if the queue is full the item is dropped (and push() returns false).
+ */
+template <typename T, std::size_t CAPACITY>
+class SpscQueue
+{
+public:
+    bool push(const T & item)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t next = (tail + 1) % CAPACITY;
+        if (next == m_head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        m_items[tail] = item;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T & item)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        item = m_items[head];
+        m_head.store((head + 1) % CAPACITY, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T                        m_items[CAPACITY];
+    std::atomic<std::size_t> m_head { 0 };
+    std::atomic<std::size_t> m_tail { 0 };
+};
@@ -0,0 +1,83 @@
+#include "Stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+/**
+ * Adds a sample.
+ */
+void Distribution::add(double sample)
+{
+    const double buckets = std::ceil(std::log2(std::max(sample, SMALLEST) / SMALLEST) * BUCKETS_PER_DOUBLING);
+    m_histogram[(int) std::min(buckets, (double) (BUCKETS - 1))]++;
+    m_max = m_count == 0 ? sample : std::max(m_max, sample);
+    m_count++;
+}
+
+/**
+ * Removes all samples.
+ */
+void Distribution::clear()
+{
+    std::fill(m_histogram, m_histogram + BUCKETS, 0);
+    m_count = 0;
+    m_max = 0;
+}
+
+/**
+ * Returns how many samples there are.
+ */
+size_t Distribution::count() const
+{
+    return m_count;
+}
+
+/**
+ * Returns the p-th percentile of the samples (nearest rank, rounded up to the top of its bucket, but never past the
+ * largest sample), or 0 if there are none.
+ * 
+ * p - percentile, from 0 to 100
+ */
+double Distribution::percentile(double p) const
+{
+    if (m_count == 0)
+    {
+        return 0;
+    }
+
+    const double rank = std::max(1.0, std::ceil(p / 100 * m_count));
+    long seen = 0;
+    int bucket = 0;
+    while (bucket < BUCKETS - 1 && seen + m_histogram[bucket] < rank)
+    {
+        seen += m_histogram[bucket];
+        bucket++;
+    }
+    return std::min(m_max, SMALLEST * std::exp2((double) bucket / BUCKETS_PER_DOUBLING));
+}
+
+/**
+ * Returns the largest sample, or 0 if there are none.
+ */
+double Distribution::max() const
+{
+    return m_count == 0 ? 0 : m_max;
+}
+
+/**
+ * Prints one line with the number of samples and their p50, p95, p99, and max.
+ * 
+ * out  - where to print
+ * name - what was measured
+ */
+void Distribution::print(std::ostream & out, const std::string & name) const
+{
+    out << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+        << "  n=" << std::setw(6) << count()
+        << "  p50=" << std::setw(7) << percentile(50)
+        << "  p95=" << std::setw(7) << percentile(95)
+        << "  p99=" << std::setw(7) << percentile(99)
+        << "  max=" << std::setw(7) << max() << "\n";
+    out << std::defaultfloat << std::setprecision(6);
+}
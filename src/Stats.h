@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+/**
+ * Collects samples of some measurement (e.g. a latency in milliseconds) and reports their distribution.
+ *
+ * Samples go into a fixed histogram (like FramePacer's), so adding one never allocates however many there are. The
+ * buckets grow geometrically, BUCKETS_PER_DOUBLING of them for every doubling, so percentiles are within about 2% of
+ * the exact ones from SMALLEST up to LARGEST (anything smaller counts as SMALLEST, anything larger as LARGEST). The
+ * largest sample is kept exactly.
+ */
+class Distribution
+{
+public:
+    static constexpr double SMALLEST                = 1.0 / 1024;
+    static constexpr double LARGEST                 = 1024.0 * 1024;
+    static const int        BUCKETS_PER_DOUBLING    = 32;
+    static const int        BUCKETS                 = 30 * BUCKETS_PER_DOUBLING + 1;   // 30 doublings, plus one for the smallest
+
+    void add(double sample);
+    void clear();
+
+    size_t count() const;
+    double percentile(double p) const;
+    double max() const;
+
+    void print(std::ostream & out, const std::string & name) const;
+
+private:
+    long    m_histogram[BUCKETS] = {};
+    size_t  m_count = 0;
+    double  m_max   = 0;
+};
+
+/**
+ * Measures time between laps (for timing systems one after another).
+ */
+class Stopwatch
+{
+public:
+    /**
+     * Returns the milliseconds since the last lap (or since the stopwatch was created), and starts a new lap.
+     */
+    double lap()
+    {
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const double ms = std::chrono::duration<double, std::milli>(now - m_start).count();
+        m_start = now;
+        return ms;
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+};
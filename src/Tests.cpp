@@ -0,0 +1,269 @@
+#include "Tests.h"
+#include "Random.h"
+#include "Stats.h"
+#include "Vec2.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// The operators are constexpr, so the compiler can check them too
+static_assert(Vec2T<float>(1, 2) + Vec2T<float>(3, 4) == Vec2T<float>(4, 6), "Vec2 + is wrong");
+static_assert(Vec2T<int>(5, 7) - Vec2T<int>(2, 3) == Vec2T<int>(3, 4), "Vec2 - is wrong");
+static_assert(Vec2T<int>(3, 4).lengthSqr() == 25, "Vec2 lengthSqr() is wrong");
+static_assert(Vec2T<int>(1, 2).dot(Vec2T<int>(3, -4)) == -5, "Vec2 dot() is wrong");
+static_assert(Vec2T<Fixed>(Fixed(1.5), Fixed(2)) * Fixed(2) == Vec2T<Fixed>(Fixed(3), Fixed(4)), "Fixed Vec2 * is wrong");
+static_assert(Vec2T<Fixed>(Fixed::fromRaw(1), Fixed(0)) != Vec2T<Fixed>(), "Fixed Vec2 != is wrong");
+
+namespace
+{
+    const double SINCOS_BOUND = 5e-7;   // fastmath::sincosDeg()'s most error against std::sin/std::cos (see FastMath.h)
+
+    // Checks run and failed so far
+    int checks = 0;
+    int failures = 0;
+
+    void check(bool ok, const char * type, const char * what)
+    {
+        checks++;
+        if (!ok)
+        {
+            failures++;
+            std::cout << "FAILED: " << type << ": " << what << "\n";
+        }
+    }
+
+    template <typename T>
+    bool near(T value, double expected, double tolerance)
+    {
+        return std::abs(static_cast<double>(value) - expected) <= tolerance;
+    }
+
+    /**
+     * Vec2 arithmetic, the same for every number type (within its precision).
+     * 
+     * type      - name of T (for the failures)
+     * tolerance - how far off results that aren't exact may be
+     */
+    template <typename T>
+    void testVec2(const char * type, double tolerance)
+    {
+        typedef Vec2T<T> V;
+        const V a(T(3), T(4));
+        const V b(T(-1), T(0.5));
+
+        check(a + b == V(T(2), T(4.5)), type, "a + b");
+        check(a - b == V(T(4), T(3.5)), type, "a - b");
+        check(a * b == V(T(-3), T(2)), type, "a * b (per component)");
+        check(a / V(T(2), T(8)) == V(T(1.5), T(0.5)), type, "a / b (per component)");
+        check(a * T(2) == V(T(6), T(8)), type, "a * s");
+
+        V c = a;
+        c += b;
+        check(c == a + b, type, "+=");
+        c -= b;
+        check(c == a, type, "-=");
+        c *= T(0.5);
+        check(c == V(T(1.5), T(2)), type, "*=");
+        c /= T(0.5);
+        check(c == a, type, "/=");
+        c.addScaled(b, T(2));
+        check(c == V(T(1), T(5)), type, "addScaled()");
+
+        check(a == V(T(3), T(4)) && !(a == b), type, "==");
+        check(a != b && !(a != V(T(3), T(4))), type, "!=");
+        check(a.dot(b) == T(-1), type, "dot()");
+        check(a.lengthSqr() == T(25), type, "lengthSqr()");
+        check(a.distSqr(b) == T(28.25), type, "distSqr()");
+        check(near(a.length(), 5, tolerance), type, "length()");
+        check(near(a.dist(b), std::sqrt(28.25), tolerance), type, "dist()");
+
+        V n = a;
+        n.normalize();
+        check(near(n.x, 0.6, tolerance) && near(n.y, 0.8, tolerance), type, "normalize()");
+        V zero;
+        zero.normalize();
+        check(zero == V(), type, "normalize() of a zero vector (left as it is)");
+
+        V p;
+        p.polar(T(90), T(2));
+        check(near(p.x, 0, tolerance) && near(p.y, 2, tolerance), type, "polar(90, 2)");
+        p.polar(T(-135), T(1));
+        check(near(p.x, -std::sqrt(0.5), tolerance) && near(p.y, -std::sqrt(0.5), tolerance), type, "polar(-135, 1)");
+    }
+
+    /**
+     * Fixed-point operators: exact results, rounding, and comparisons of values a single step apart.
+     */
+    void testFixed()
+    {
+        const char * type = "Fixed";
+        const Fixed step = Fixed::fromRaw(1);
+
+        check(Fixed(3) * Fixed(0.5) == Fixed(1.5), type, "*");
+        check(Fixed(1) / Fixed(4) == Fixed(0.25), type, "/");
+        check(Fixed(-7) / Fixed(2) == Fixed(-3.5), type, "/ (negative)");
+        check(Fixed(1.0 / 65536) == step && Fixed(-1.0 / 65536) == -step, type, "from double");
+        check(Fixed(0.49 / 65536) == Fixed(), type, "from double (rounds to nearest)");
+        check(static_cast<int>(Fixed(-0.5)) == -1, type, "to int (floors)");
+
+        check(Fixed(1) != Fixed(1) + step, type, "!= (one step apart)");
+        check(!(Fixed(1) != Fixed(1)), type, "!= (equal)");
+        check(Fixed(1) < Fixed(1) + step && Fixed(1) + step > Fixed(1), type, "< and >");
+        check(Vec2T<Fixed>(Fixed(1), Fixed(2)) != Vec2T<Fixed>(Fixed(1), Fixed(2) + step), type, "Vec2 != (y one step apart)");
+        check(!(Vec2T<Fixed>(Fixed(1), Fixed(2)) != Vec2T<Fixed>(Fixed(1), Fixed(2))), type, "Vec2 != (equal)");
+
+        check(sqrt(Fixed(16)) == Fixed(4), type, "sqrt(16)");
+        check(near(sqrt(Fixed(2)), std::sqrt(2.0), 1.0 / 65536), type, "sqrt(2)");
+        check(sqrt(Fixed(-1)) == Fixed(), type, "sqrt(-1)");
+
+        // Products that only fit in 128 bits on the way
+        check(Fixed(100000) * Fixed(100000) == Fixed(10000000000LL), type, "* (big)");
+    }
+
+    /**
+     * The SSE float versions must give exactly what the generic ones would (sqrt and division are correctly rounded
+     * either way).
+     */
+    void testVec2Sse()
+    {
+#if defined(__SSE2__)
+        const char * type = "float (SSE)";
+        Random random(7);
+        bool length = true;
+        bool dist = true;
+        bool normalize = true;
+        for (int i = 0; i < 100000; i++)
+        {
+            const Vec2T<float> a(random.fromRange(-100000, 100000) / 7.0f, random.fromRange(-100000, 100000) / 13.0f);
+            const Vec2T<float> b(random.fromRange(-100000, 100000) / 3.0f, random.fromRange(-100000, 100000) / 11.0f);
+
+            const float genericLength = std::sqrt(a.lengthSqr());
+            length = length && a.length() == genericLength;
+            dist = dist && a.dist(b) == std::sqrt(a.distSqr(b));
+
+            Vec2T<float> n = a;
+            n.normalize();
+            normalize = normalize && (genericLength == 0 || (n.x == a.x / genericLength && n.y == a.y / genericLength));
+        }
+        check(length, type, "length() == generic");
+        check(dist, type, "dist() == generic");
+        check(normalize, type, "normalize() == generic");
+#else
+        std::cout << "(no SSE: float uses the generic Vec2)\n";
+#endif
+    }
+
+    /**
+     * fastmath::sincosDeg() (one angle, and the batch version) against std::sin/std::cos, over FastMath.h's range
+     * ([-1e5, 1e5] degrees) and densely over one turn. Fails if either is ever further off than SINCOS_BOUND.
+     */
+    void testSinCos()
+    {
+        const double pi = 3.14159265358979323846;
+        const size_t BATCH = 1024;
+        std::vector<float> angles;
+        std::vector<float> sines(BATCH);
+        std::vector<float> cosines(BATCH);
+        angles.reserve(BATCH);
+
+        double worst = 0;
+        double worstBatch = 0;
+        double worstAngle = 0;
+        auto checkBatch = [&]()
+        {
+            fastmath::sincosDeg(angles.data(), sines.data(), cosines.data(), angles.size());
+            for (size_t i = 0; i < angles.size(); i++)
+            {
+                // Against the angle as the float it is (what the caller passed)
+                const double radians = static_cast<double>(angles[i]) * pi / 180;
+                float s, c;
+                fastmath::sincosDeg(angles[i], s, c);
+                const double error = std::max(std::abs(s - std::sin(radians)), std::abs(c - std::cos(radians)));
+                if (error > worst)
+                {
+                    worst = error;
+                    worstAngle = angles[i];
+                }
+                worstBatch = std::max(worstBatch, std::max(std::abs(sines[i] - std::sin(radians)), std::abs(cosines[i] - std::cos(radians))));
+            }
+            angles.clear();
+        };
+
+        const int WIDE = 2000000;
+        for (int i = 0; i <= WIDE; i++)
+        {
+            angles.push_back(static_cast<float>(-1e5 + 2e5 * i / WIDE + 0.0001 * (i % 7)));
+            if (angles.size() == BATCH)
+            {
+                checkBatch();
+            }
+        }
+        for (int i = 0; i < 360000; i++)
+        {
+            angles.push_back(static_cast<float>(i * 0.001));
+            if (angles.size() == BATCH)
+            {
+                checkBatch();
+            }
+        }
+        checkBatch();
+
+        std::cout << "sincosDeg: worst error " << worst << " (at " << worstAngle << " degrees), batch " << worstBatch << ", bound " << SINCOS_BOUND << "\n";
+        check(worst <= SINCOS_BOUND, "float", "sincosDeg() within its bound of std::sin/std::cos");
+        check(worstBatch <= SINCOS_BOUND, "float", "sincosDeg() (batch) within its bound of std::sin/std::cos");
+    }
+
+    /**
+     * Distribution's percentiles (from its histogram) against the exact ones of the same samples, which they must be
+     * within a bucket (about 2%) of.
+     */
+    void testDistribution()
+    {
+        Random random(11);
+        Distribution distribution;
+        std::vector<double> samples;
+        for (int i = 0; i < 100000; i++)
+        {
+            // Spread over a few orders of magnitude, like frame times with the odd hitch
+            const double sample = std::exp2(random.fromRange(0, 1000000) / 1e5 - 5);
+            distribution.add(sample);
+            samples.push_back(sample);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        const double BUCKET = std::exp2(1.0 / Distribution::BUCKETS_PER_DOUBLING);
+        for (double p : { 1.0, 50.0, 95.0, 99.0, 100.0 })
+        {
+            const double exact = samples[(size_t) std::ceil(p / 100 * samples.size()) - 1];
+            const double value = distribution.percentile(p);
+            check(value >= exact && value <= exact * BUCKET, "double", "Distribution percentile within a bucket of the exact one");
+        }
+        check(distribution.count() == samples.size(), "double", "Distribution count()");
+        check(distribution.max() == samples.back(), "double", "Distribution max() exact");
+
+        distribution.clear();
+        distribution.add(0);
+        check(distribution.count() == 1 && distribution.percentile(50) == 0 && distribution.max() == 0, "double", "Distribution of zeros");
+    }
+}
+
+int runMathTests()
+{
+    testVec2<float>("float", 1e-6);
+    testVec2<double>("double", 1e-12);
+    testVec2<Fixed>("Fixed", 4.0 / 65536);
+    testFixed();
+    testVec2Sse();
+    testSinCos();
+    testDistribution();
+
+    std::cout << "math tests: " << checks - failures << "/" << checks << " passed\n";
+    if (failures > 0)
+    {
+        std::cout << "Error " << failures << " math tests failed.\n";
+        return 1;
+    }
+    return 0;
+}
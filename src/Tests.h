@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ * Checks the math the simulation is built on: Vec2 with float, double and fixed-point numbers (and its SSE float
+ * versions against the generic ones), the fixed-point operators, and fastmath::sincosDeg() against std::sin/std::cos
+ * (it must stay within the error bound FastMath.h gives), and Distribution's percentiles against exact ones.
+ * 
+ * Prints every check that fails, and a summary. Returns the process exit code: non-zero if any check failed.
+ */
+int runMathTests();
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * Lock-free triple buffer, for handing the latest version of something from one thread to another.
+ * 
+ * The writer fills writeBuffer() and publish()es it, the reader calls update() and reads readBuffer().
+ * Neither side ever waits for the other: the writer always has a buffer to write to, and the reader
+ * always has the newest complete buffer to read (versions the reader was too slow to see are skipped).
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Writer side
+
+    T & writeBuffer()
+    {
+        return m_buffers[m_writeIndex];
+    }
+
+    void publish()
+    {
+        m_writeIndex = m_middle.exchange(m_writeIndex | NEW_DATA, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader side
+
+    /**
+     * Switches to the newest published buffer. Returns false if nothing was published since the last call.
+     */
+    bool update()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & NEW_DATA) == 0)
+        {
+            return false;
+        }
+
+        m_readIndex = m_middle.exchange(m_readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T & readBuffer() const
+    {
+        return m_buffers[m_readIndex];
+    }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int NEW_DATA   = 4;
+
+    T                m_buffers[3];
+    int              m_writeIndex   = 0;
+    int              m_readIndex    = 1;
+    std::atomic<int> m_middle       { 2 };  // the buffer between the two, plus the NEW_DATA flag
+};
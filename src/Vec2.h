@@ -1,32 +1,135 @@
 #pragma once
 
-class Vec2
+#include <cmath>
+#include "FastMath.h"
+#include "Fixed.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * 2D vector.
+ * 
+ * Everything is defined here (header only) so that the compiler can inline vector math into the systems that use it.
+ * Works with any number type that has the usual arithmetic operators and a sqrt() (float, double, fixed-point).
+ */
+template <typename T>
+class Vec2T
 {
 public:
-    float x = 0;
-    float y = 0;
+    T x = 0;
+    T y = 0;
+
+    constexpr Vec2T() {}
+    constexpr Vec2T(T x, T y)
+        : x(x), y(y) {}
+
+    constexpr bool operator == (const Vec2T& rhs) const { return x == rhs.x && y == rhs.y; }
+    constexpr bool operator != (const Vec2T& rhs) const { return !(*this == rhs); }
+
+    constexpr Vec2T operator + (const Vec2T& rhs) const { return Vec2T(x + rhs.x, y + rhs.y); }
+    constexpr Vec2T operator - (const Vec2T& rhs) const { return Vec2T(x - rhs.x, y - rhs.y); }
+    constexpr Vec2T operator * (const Vec2T& rhs) const { return Vec2T(x * rhs.x, y * rhs.y); }
+    constexpr Vec2T operator / (const Vec2T& rhs) const { return Vec2T(x / rhs.x, y / rhs.y); }
+    constexpr Vec2T operator * (const T val) const { return Vec2T(x * val, y * val); }
+
+    constexpr Vec2T& operator += (const Vec2T& rhs) { x += rhs.x; y += rhs.y; return *this; }
+    constexpr Vec2T& operator -= (const Vec2T& rhs) { x -= rhs.x; y -= rhs.y; return *this; }
+    constexpr Vec2T& operator *= (const T val) { x *= val; y *= val; return *this; }
+    constexpr Vec2T& operator /= (const T val) { x /= val; y /= val; return *this; }
+
+    constexpr T dot       (const Vec2T& v) const { return x * v.x + y * v.y; }
+    constexpr T lengthSqr () const { return dot(*this); }
+    constexpr T distSqr   (const Vec2T& v) const { return (*this - v).lengthSqr(); }
+
+    /**
+     * Fused multiply-add: this += v * s (without making a temporary vector).
+     */
+    constexpr Vec2T& addScaled(const Vec2T& v, const T s) { x += v.x * s; y += v.y * s; return *this; }
+
+    T length() const
+    {
+        using std::sqrt;
+        return sqrt(lengthSqr());
+    }
 
-    bool operator == (const Vec2& rhs) const;
-    bool operator != (const Vec2& rhs) const;
+    T dist(const Vec2T& v) const
+    {
+        using std::sqrt;
+        return sqrt(distSqr(v));
+    }
 
-    Vec2 operator +  (const Vec2& rhs) const;
-    Vec2 operator -  (const Vec2& rhs) const;
-    Vec2 operator *  (const Vec2& rhs) const;
-    Vec2 operator /  (const Vec2& rhs) const;
-    Vec2 operator * (const float val) const;
+    /**
+     * Scales this vector to a length of 1. A vector with no length is left as it is.
+     */
+    void normalize()
+    {
+        const T l = length();
+        if (l == T(0))
+        {
+            return;
+        }
+        x = x/l;
+        y = y/l;
+    }
 
-    void operator += (const Vec2& rhs);
-    void operator -= (const Vec2& rhs);
-    void operator *= (const float val);
-    void operator /= (const float val);
+    /**
+     * Sets this vector from polar coordinates.
+     * 
+     * a - angle in degrees
+     * r - length
+     */
+    void polar(const T a, const T r)
+    {
+        using fastmath::sincosDeg;
+        T s, c;
+        sincosDeg(a, s, c);
+        x = r * c;
+        y = r * s;
+    }
+};
 
+// Doubles are for precision, which the float sin/cos table would throw away, so they use the standard library's
+template <>
+inline void Vec2T<double>::polar(const double a, const double r)
+{
+    const double radians = a * 3.14159265358979323846 / 180;
+    x = r * std::cos(radians);
+    y = r * std::sin(radians);
+}
+
+#if defined(__SSE2__)
+// SSE versions for float. sqrtss doesn't need the errno check that std::sqrt() has to do (which stops GCC from
+// inlining it cleanly), and normalize() divides both components with a single instruction.
+
+template <>
+inline float Vec2T<float>::length() const
+{
+    return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(lengthSqr())));
+}
+
+template <>
+inline float Vec2T<float>::dist(const Vec2T<float>& v) const
+{
+    return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(distSqr(v))));
+}
+
+template <>
+inline void Vec2T<float>::normalize()
+{
+    const float lengthSquared = lengthSqr();
+    if (lengthSquared == 0.0f)
+    {
+        return;
+    }
 
-    Vec2();
-    Vec2(float x, float y);
+    const __m128 xy = _mm_setr_ps(x, y, 0.0f, 0.0f);
+    const __m128 l = _mm_sqrt_ps(_mm_set1_ps(lengthSquared));
+    const __m128 n = _mm_div_ps(xy, l);
+    x = _mm_cvtss_f32(n);
+    y = _mm_cvtss_f32(_mm_shuffle_ps(n, n, _MM_SHUFFLE(1, 1, 1, 1)));
+}
+#endif
 
-    void   normalize ();
-    float  length    () const;
-    float  dist      (const Vec2& v) const;
-    float  distSqr   (const Vec2& v) const;
-    void   polar     (const float a, const float r);
-};
\ No newline at end of file
+typedef Vec2T<Real> Vec2;
@@ -1,7 +1,156 @@
 #include "Game.h"
+#include "Alloc.h"
+#include "BatchRunner.h"
+#include "Bench.h"
+#include "Tests.h"
 
-int main() 
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/**
+ * Usage:
+ *   Game.exe [--pacing <mode>]                  single player (mode is vsync, fixed (default), or uncapped)
+ *   Game.exe ... --strict-alloc                 debug: abort if a system that shouldn't allocate does
+ *   Game.exe ... --world <width> <height>       play in a world bigger than the window (the camera follows the player)
+ *   Game.exe ... --voices <n>                   sound effects that can play at once
+ *   Game.exe --net <player> <localPort> <remotePort> [--delay <ms>] [--loss <percent>] [--seed <n>]
+ *                                               netplay co-op (player is 0 or 1, run one game per player)
+ *   Game.exe --bench-math                       float vs fixed-point math benchmark
+ *   Game.exe --bench-particles                  particle system benchmark
+ *   Game.exe --bench-audio                      sound mixing benchmark (offline, no audio device needed)
+ *   Game.exe --test-math                        checks Vec2 and fixed-point math (exit code 1 if anything is wrong)
+ *   Game.exe --render <ticks> <file> [--seed <n>] [--threads <n>] [--enemies <n>] [--expect <checksum>]
+ *                                               headless: plays a scripted game and saves its last frame (.png or .ppm),
+ *                                               with n extra enemies spread over the world (exit code 1 if the image's
+ *                                               checksum isn't the expected one)
+ *   Game.exe --batch <games> <ticks> [--seed <n>] [--threads <n>] [--set <section>.<name>=<value>[:<last>]]...
+ *                                               batch: plays many scripted games at once on every core (for balance
+ *                                               tuning), with enemy/nuke settings overridden (or spread over the games)
+ */
+int main(int argc, char * argv[]) 
 {
-    Game g;
-    g.run();
-}
\ No newline at end of file
+    NetConfig netConfig;
+    RenderConfig renderConfig;
+    WorldConfig worldConfig;
+    AudioConfig audioConfig;
+    BatchConfig batchConfig;
+    bool batch = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+
+        if (arg == "--bench-math")
+        {
+            return runMathBenchmark();
+        }
+        else if (arg == "--bench-particles")
+        {
+            return runParticleBenchmark();
+        }
+        else if (arg == "--bench-audio")
+        {
+            return runAudioBenchmark();
+        }
+        else if (arg == "--test-math")
+        {
+            return runMathTests();
+        }
+        else if (arg == "--net" && i + 3 < argc)
+        {
+            netConfig.ENABLED = true;
+            netConfig.PLAYER = std::atoi(argv[++i]) == 0 ? 0 : 1;
+            netConfig.LOCAL_PORT = std::atoi(argv[++i]);
+            netConfig.REMOTE_PORT = std::atoi(argv[++i]);
+        }
+        else if (arg == "--render" && i + 2 < argc)
+        {
+            renderConfig.HEADLESS = true;
+            renderConfig.TICKS = std::atoi(argv[++i]);
+            renderConfig.OUTPUT = argv[++i];
+        }
+        else if (arg == "--batch" && i + 2 < argc)
+        {
+            batch = true;
+            batchConfig.INSTANCES = std::atoi(argv[++i]);
+            batchConfig.TICKS = std::atoi(argv[++i]);
+        }
+        else if (arg == "--set" && i + 1 < argc)
+        {
+            batchConfig.SET.push_back(argv[++i]);
+        }
+        else if (arg == "--pacing" && i + 1 < argc)
+        {
+            if (!FramePacer::parseMode(argv[++i], renderConfig.PACING))
+            {
+                std::cout << "Unknown pacing mode: " << argv[i] << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--strict-alloc")
+        {
+            alloc::setStrict(true);
+        }
+        else if (arg == "--world" && i + 2 < argc)
+        {
+            worldConfig.W = std::atoi(argv[++i]);
+            worldConfig.H = std::atoi(argv[++i]);
+        }
+        else if (arg == "--voices" && i + 1 < argc)
+        {
+            audioConfig.VOICES = std::atoi(argv[++i]);
+        }
+        else if (arg == "--enemies" && i + 1 < argc)
+        {
+            renderConfig.ENEMIES = std::atoi(argv[++i]);
+        }
+        else if (arg == "--expect" && i + 1 < argc)
+        {
+            renderConfig.EXPECT = argv[++i];
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            renderConfig.THREADS = std::atoi(argv[++i]);
+        }
+        else if (arg == "--delay" && i + 1 < argc)
+        {
+            netConfig.DELAY = std::atoi(argv[++i]);
+        }
+        else if (arg == "--loss" && i + 1 < argc)
+        {
+            netConfig.LOSS = std::atoi(argv[++i]);
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+        {
+            netConfig.SEED = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            std::cout << "Unknown argument: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (renderConfig.HEADLESS && netConfig.ENABLED)
+    {
+        std::cout << "Error headless mode can't be used with netplay.\n";
+        return 1;
+    }
+
+    if (batch)
+    {
+        if (renderConfig.HEADLESS || netConfig.ENABLED)
+        {
+            std::cout << "Error batch mode can't be used with headless mode or netplay.\n";
+            return 1;
+        }
+
+        batchConfig.SEED = netConfig.SEED;
+        batchConfig.THREADS = renderConfig.THREADS;
+        return runBatch(batchConfig, worldConfig);
+    }
+
+    Game g(netConfig, renderConfig, worldConfig, audioConfig);
+    return g.run();
+}
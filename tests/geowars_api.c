@@ -0,0 +1,155 @@
+/*
+ * Checks libgeowars.so through its C API, compiled as C (so GeoWars.h is checked to be plain C too): a game is created,
+ * played by a scripted player until it's over, reset, played again the same way, and destroyed.
+ *
+ * Run by: make lib-test (and make test)
+ */
+
+#include <stdio.h>
+#include "GeoWars.h"
+
+#define MAX_ENTITIES 4096
+#define MAX_STEPS 100000    /* a game that isn't over by now never will be */
+
+static int checks = 0;
+static int failures = 0;
+
+/* Counts a check, and prints it if it failed */
+static void check(int ok, const char * what)
+{
+    checks++;
+    if (!ok)
+    {
+        failures++;
+        printf("FAILED: %s\n", what);
+    }
+}
+
+/* Fires at the first enemy in the observation (or nowhere in particular, if there are none), moving in circles */
+static geowars_action scriptedAction(const geowars_observation * observation, int tick)
+{
+    geowars_action action = { 0 };
+    int i;
+
+    action.up = (tick / 60) % 4 == 0;
+    action.right = (tick / 60) % 4 == 1;
+    action.down = (tick / 60) % 4 == 2;
+    action.left = (tick / 60) % 4 == 3;
+    action.shoot = tick % 4 == 0;
+    action.aim_x = (float) ((tick * 37) % 1280);
+    action.aim_y = (float) ((tick * 23) % 720);
+    for (i = 0; i < observation->count; i++)
+    {
+        if (observation->tag[i] == GEOWARS_ENEMY)
+        {
+            action.aim_x = observation->x[i];
+            action.aim_y = observation->y[i];
+            break;
+        }
+    }
+    return action;
+}
+
+/*
+ * Plays the game until it's over, checking every step's observation. Returns the ticks it took (-1 if it didn't end).
+ */
+static int playUntilDone(geowars * game)
+{
+    const geowars_observation * observation = geowars_observe(game);
+    int steps = 0;
+    int done = 0;
+    int sawEnemy = 0;
+    int sawBullet = 0;
+    int countsOk = 1;
+    int tagsOk = 1;
+    int playerFirstOk = 1;
+    int ticksOk = 1;
+
+    while (!done && steps < MAX_STEPS)
+    {
+        const geowars_action action = scriptedAction(observation, steps);
+        int i;
+
+        done = geowars_step(game, &action);
+        steps++;
+        if (done < 0)
+        {
+            check(0, "geowars_step() returns 0 or 1");
+            return -1;
+        }
+
+        countsOk = countsOk && observation->count >= 0 && observation->count <= observation->capacity;
+        for (i = 0; i < observation->count; i++)
+        {
+            tagsOk = tagsOk && observation->tag[i] <= GEOWARS_NUKE && observation->radius[i] > 0;
+            sawEnemy = sawEnemy || observation->tag[i] == GEOWARS_ENEMY;
+            sawBullet = sawBullet || observation->tag[i] == GEOWARS_BULLET;
+        }
+
+        /* The player is first, for as long as they're alive (and the tick only counts while they are) */
+        if (!done)
+        {
+            playerFirstOk = playerFirstOk && observation->count > 0 && observation->tag[0] == GEOWARS_PLAYER;
+            ticksOk = ticksOk && geowars_tick(game) == steps;
+        }
+    }
+
+    check(done == 1, "the game is over within MAX_STEPS");
+    check(countsOk, "observation count is within its capacity");
+    check(tagsOk, "observation tags are known ones, and radii are positive");
+    check(playerFirstOk, "the player is the first entity until the game is over");
+    check(ticksOk, "geowars_tick() counts the steps until the game is over");
+    check(sawEnemy, "enemies are observed");
+    check(sawBullet, "the player's bullets are observed");
+    check(geowars_done(game) == 1, "geowars_done() once the game is over");
+    check(observation->count == 0 || observation->tag[0] != GEOWARS_PLAYER, "no player once the game is over");
+
+    printf("game over after %d steps, score: %d\n", steps, geowars_score(game));
+    return done ? steps : -1;
+}
+
+int main(void)
+{
+    geowars * game;
+    const geowars_observation * observation;
+    const float * x;
+    int steps;
+    int score;
+
+    check(geowars_api_version() == GEOWARS_API_VERSION, "the library is the API version this was built against");
+
+    game = geowars_create(1, 0, 0, MAX_ENTITIES);
+    check(game != NULL, "geowars_create()");
+    if (game == NULL)
+    {
+        printf("Error with creating a game.\n");
+        return 1;
+    }
+
+    observation = geowars_observe(game);
+    x = observation->x;
+    check(observation->capacity == MAX_ENTITIES, "observation capacity is max_entities");
+    check(observation->count == 0 && geowars_tick(game) == 0 && geowars_done(game) == 0, "a new game is empty, at tick 0, and not over");
+
+    steps = playUntilDone(game);
+    score = geowars_score(game);
+    check(geowars_step(game, NULL) == 1 && geowars_tick(game) == steps, "a game that's over stays over, and stops counting ticks");
+
+    /* Reset: back to the beginning, with the observation where it was */
+    check(geowars_reset(game, 1) == 0, "geowars_reset()");
+    check(geowars_observe(game) == observation && observation->x == x, "the observation doesn't move on reset");
+    check(observation->count == 0 && geowars_tick(game) == 0 && geowars_done(game) == 0, "a reset game is empty, at tick 0, and not over");
+
+    /* The same seed and actions play out the same */
+    check(playUntilDone(game) == steps && geowars_score(game) == score, "the game plays out the same after reset with the same seed");
+
+    geowars_destroy(game);
+
+    printf("C API tests: %d/%d passed\n", checks - failures, checks);
+    if (failures > 0)
+    {
+        printf("Error %d C API tests failed.\n", failures);
+        return 1;
+    }
+    return 0;
+}